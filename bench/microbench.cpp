@@ -0,0 +1,220 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <string>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+
+#include "attackTables.h"
+#include "board.h"
+#include "search.h"
+#include "transpositionTable.h"
+#include "constants.h"
+
+using namespace std;
+
+struct slidingLookup {
+    char square;
+    uint64_t occupiedSquares;
+};
+
+//time how many rook and bishop lookups a backend can do per second
+//the checksum is returned so that the lookups can't be optimised away, and so that the backends can be checked against each other
+double benchmarkSlidingLookups(const AttackTables& attackTables, const vector<slidingLookup>& lookups, int repetitions, uint64_t* checksum) {
+    *checksum = 0ull;
+    auto startTime = chrono::high_resolution_clock::now();
+    for (int repetition = 0; repetition < repetitions; repetition++) {
+        for (const slidingLookup& lookup : lookups) {
+            *checksum += attackTables.getRookMoves(lookup.square, lookup.occupiedSquares);
+            *checksum += attackTables.getBishopMoves(lookup.square, lookup.occupiedSquares);
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::high_resolution_clock::now() - startTime).count();
+    return 2.0 * lookups.size() * repetitions / seconds;
+}
+
+void benchmarkBackend(bool usePext, const vector<slidingLookup>& lookups, int repetitions) {
+    auto attackTables = make_unique<AttackTables>(usePext);
+    cout << (usePext ? "pext" : "magic") << " (" << attackTables->getSlidingTableBytes() / 1024 << "KB of tables)\n";
+    //one pass to warm up the caches, then the timed passes
+    uint64_t checksum;
+    benchmarkSlidingLookups(*attackTables, lookups, 1, &checksum);
+    double lookupsPerSecond = benchmarkSlidingLookups(*attackTables, lookups, repetitions, &checksum);
+    cout << "  " << lookupsPerSecond / 1000000.0 << " million lookups per second, " << 1000000000.0 / lookupsPerSecond << "ns per lookup\n";
+    cout << "  checksum " << checksum << "\n";
+}
+
+//times a component by running it over the whole corpus, first a few times to warm up the caches and branch predictors,
+//then a number of timed repetitions, and prints the median, fastest and slowest time per operation
+//run returns the number of operations it did and adds to the checksum, so that the work can't be optimised away
+void benchmarkComponent(const string& name, const function<long long(uint64_t*)>& run, int warmUps, int repetitions) {
+    uint64_t checksum = 0ull;
+    for (int i = 0; i < warmUps; i++) {
+        run(&checksum);
+    }
+
+    vector<double> nsPerOp(repetitions);
+    for (int i = 0; i < repetitions; i++) {
+        auto startTime = chrono::high_resolution_clock::now();
+        long long numOps = run(&checksum);
+        double nanoseconds = chrono::duration<double, nano>(chrono::high_resolution_clock::now() - startTime).count();
+        nsPerOp[i] = nanoseconds / numOps;
+    }
+    sort(nsPerOp.begin(), nsPerOp.end());
+    double median = nsPerOp[repetitions / 2];
+
+    cout << "  " << name << ": " << median << "ns per op (fastest " << nsPerOp.front() << ", slowest " << nsPerOp.back()
+        << "), " << 1000.0 / median << " million ops per second, checksum " << checksum << "\n";
+}
+
+//the bench positions, and the positions reached by playing a few random moves from each of them
+vector<Board> getCorpus() {
+    mt19937_64 random(353);
+    vector<Board> corpus;
+    for (int i = 0; i < constants::NUM_BENCH_POSITIONS; i++) {
+        Board board;
+        board.loadFromFen(constants::BENCH_POSITIONS[i]);
+        corpus.push_back(board);
+        for (int walk = 0; walk < 3; walk++) {
+            Board walkBoard = board;
+            for (int ply = 0; ply < 4 * (walk + 1); ply++) {
+                MoveList moves;
+                walkBoard.getLegalMoves(&moves);
+                if (moves.size() == 0) {
+                    break;
+                }
+                walkBoard.makeMove(moves.getMove(random() % moves.size()));
+            }
+            corpus.push_back(walkBoard);
+        }
+    }
+    return corpus;
+}
+
+void benchmarkComponents() {
+    const int warmUps = 3;
+    const int repetitions = 15;
+    vector<Board> corpus = getCorpus();
+    cout << "components, over " << corpus.size() << " positions\n";
+
+    //the legal moves of every position, for timing making and unmaking them
+    vector<MoveList> corpusMoves(corpus.size());
+    for (size_t i = 0; i < corpus.size(); i++) {
+        corpus[i].getLegalMoves(&corpusMoves[i]);
+    }
+
+    //each component goes over the corpus enough times for a repetition to take a few milliseconds
+    benchmarkComponent("getLegalMoves", [&](uint64_t* checksum) {
+        MoveList moves;
+        for (int pass = 0; pass < 2000; pass++) {
+            for (Board& board : corpus) {
+                board.getLegalMoves(&moves);
+                *checksum += moves.size();
+            }
+        }
+        return 2000ll * corpus.size();
+    }, warmUps, repetitions);
+
+    benchmarkComponent("getCaptureMoves", [&](uint64_t* checksum) {
+        MoveList moves;
+        for (int pass = 0; pass < 2000; pass++) {
+            for (Board& board : corpus) {
+                board.prepareMoveGeneration();
+                board.getCaptureMoves(&moves);
+                *checksum += moves.size();
+            }
+        }
+        return 2000ll * corpus.size();
+    }, warmUps, repetitions);
+
+    benchmarkComponent("makeMove + unMakeMove", [&](uint64_t* checksum) {
+        long long numOps = 0;
+        for (int pass = 0; pass < 300; pass++) {
+            for (size_t i = 0; i < corpus.size(); i++) {
+                for (int moveNum = 0; moveNum < corpusMoves[i].size(); moveNum++) {
+                    corpus[i].makeMove(corpusMoves[i].getMove(moveNum));
+                    *checksum += corpus[i].getZobristKey(corpus[i].getPly());
+                    corpus[i].unMakeMove(corpusMoves[i].getMove(moveNum));
+                }
+                numOps += corpusMoves[i].size();
+            }
+        }
+        return numOps;
+    }, warmUps, repetitions);
+
+    benchmarkComponent("setZobristKey", [&](uint64_t* checksum) {
+        for (int pass = 0; pass < 2000; pass++) {
+            for (Board& board : corpus) {
+                board.setZobristKey();
+                *checksum += board.getZobristKey(board.getPly());
+            }
+        }
+        return 2000ll * corpus.size();
+    }, warmUps, repetitions);
+
+    //each search needs a board to point at, and evaluate uses the search's pawn hash table like it does while searching
+    TranspositionTable transpositionTable(64);
+    transpositionTable.allocate();
+    deque<Search> searches;
+    for (Board& board : corpus) {
+        searches.emplace_back(&board, &transpositionTable);
+    }
+    benchmarkComponent("Search::evaluate", [&](uint64_t* checksum) {
+        for (int pass = 0; pass < 20000; pass++) {
+            for (Search& search : searches) {
+                *checksum += search.evaluate();
+            }
+        }
+        return 20000ll * searches.size();
+    }, warmUps, repetitions);
+    searches.clear();
+
+    //random keys spread over the whole table, so most probes and records miss the caches as they do while searching
+    mt19937_64 random(353);
+    vector<uint64_t> keys(1 << 20);
+    for (uint64_t& key : keys) {
+        key = random();
+    }
+    benchmarkComponent("recordHash", [&](uint64_t* checksum) {
+        for (size_t i = 0; i < keys.size(); i++) {
+            transpositionTable.recordHash(keys[i], i % 20, i % 1000, i % 3, i & 0xfff);
+        }
+        *checksum += keys.size();
+        return static_cast<long long>(keys.size());
+    }, warmUps, repetitions);
+    benchmarkComponent("probeHash", [&](uint64_t* checksum) {
+        for (size_t i = 0; i < keys.size(); i++) {
+            int eval = 0;
+            Move bestMove = NULL_MOVE;
+            *checksum += transpositionTable.probeHash(&eval, keys[i], 10, -100, 100, &bestMove) + bestMove;
+        }
+        return static_cast<long long>(keys.size());
+    }, warmUps, repetitions);
+}
+
+int main() {
+    //random squares and occupancies, with roughly a third of the board occupied as in a middlegame
+    mt19937_64 random(353);
+    vector<slidingLookup> lookups(1 << 16);
+    for (slidingLookup& lookup : lookups) {
+        lookup.square = random() % 64;
+        lookup.occupiedSquares = random() & random();
+    }
+    const int repetitions = 200;
+
+    cout << "sliding piece lookups\n";
+    benchmarkBackend(false, lookups, repetitions);
+    if (AttackTables::isPextSupported()) {
+        benchmarkBackend(true, lookups, repetitions);
+    }
+    else {
+        cout << "pext isn't supported on this cpu\n";
+    }
+    cout << "the engine uses " << (AttackTables::isPextFast() ? "pext" : "magic") << " on this cpu\n";
+
+    benchmarkComponents();
+}
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+#include "attackTables.h"
+#include "bitboard.h"
+
+using namespace std;
+
+const AttackTables& AttackTables::get() {
+    static const AttackTables attackTables(isPextFast());
+    return attackTables;
+}
+
+//read whether the cpu supports bmi2, whether it is made by amd, and its family from cpuid
+void AttackTables::readCpuInfo(bool* bmi2, bool* amd, unsigned int* family) {
+    *bmi2 = *amd = false;
+    *family = 0;
+#ifdef PEXT_AVAILABLE
+#if defined(_MSC_VER)
+    int registers[4];
+    __cpuid(registers, 0);
+    *amd = registers[2] == 0x444d4163; //"cAMD" from "AuthenticAMD"
+    int maxLeaf = registers[0];
+    __cpuid(registers, 1);
+    unsigned int version = registers[0];
+    if (maxLeaf >= 7) {
+        __cpuidex(registers, 7, 0);
+        *bmi2 = (registers[1] >> 8) & 1;
+    }
+#else
+    unsigned int registers[4];
+    __cpuid(0, registers[0], registers[1], registers[2], registers[3]);
+    *amd = registers[2] == 0x444d4163; //"cAMD" from "AuthenticAMD"
+    unsigned int maxLeaf = registers[0];
+    __cpuid(1, registers[0], registers[1], registers[2], registers[3]);
+    unsigned int version = registers[0];
+    if (maxLeaf >= 7) {
+        __cpuid_count(7, 0, registers[0], registers[1], registers[2], registers[3]);
+        *bmi2 = (registers[1] >> 8) & 1;
+    }
+#endif
+    *family = ((version >> 8) & 0xf) + ((version >> 20) & 0xff);
+#endif
+}
+
+bool AttackTables::isPextSupported() {
+    bool bmi2, amd;
+    unsigned int family;
+    readCpuInfo(&bmi2, &amd, &family);
+    return bmi2;
+}
+
+bool AttackTables::isPextFast() {
+    bool bmi2, amd;
+    unsigned int family;
+    readCpuInfo(&bmi2, &amd, &family);
+    //amd cpus before zen 3 (family 0x19) run pext in microcode, which is far slower than a magic lookup
+    return bmi2 && (!amd || (family >= 0x19));
+}
+
+AttackTables::AttackTables(bool usePext) : m_slidingTableSize(0), m_usePext(usePext) {
+    initSlidingTable(m_rookMagics, constants::ROOK_MAGICS, constants::ROOK_SHIFTS, false);
+    initSlidingTable(m_bishopMagics, constants::BISHOP_MAGICS, constants::BISHOP_SHIFTS, true);
+}
+
+//the directions that rooks and bishops move in
+const char ROOK_X_OFFSETS[4] = { -1, 1, 0, 0 };
+const char ROOK_Y_OFFSETS[4] = { 0, 0, -1, 1 };
+const char BISHOP_X_OFFSETS[4] = { -1, 1, -1, 1 };
+const char BISHOP_Y_OFFSETS[4] = { -1, -1, 1, 1 };
+
+uint64_t AttackTables::getBlockerMask(char square, bool bishop) {
+    const char* xOffsets = bishop ? BISHOP_X_OFFSETS : ROOK_X_OFFSETS;
+    const char* yOffsets = bishop ? BISHOP_Y_OFFSETS : ROOK_Y_OFFSETS;
+    //the mask is every square the piece can move to on an empty board, apart from the last square in each direction,
+    //as a piece on the edge of the board doesn't block anything
+    uint64_t mask = 0ull;
+    for (int direction = 0; direction < 4; direction++) {
+        uint64_t ray = calculateRay(square, 0ull, xOffsets[direction], yOffsets[direction]);
+        if (ray) {
+            //the furthest square along the ray is its highest bit if the ray goes towards the higher square numbers
+            bool towardsHigherSquares = (xOffsets[direction] + yOffsets[direction] * 8) > 0;
+            uint64_t edgeSquare = towardsHigherSquares ? 1ull << (63 - std::__countl_zero(ray)) : 1ull << lsb(ray);
+            mask |= ray ^ edgeSquare;
+        }
+    }
+    return mask;
+}
+
+uint64_t AttackTables::calculateSlidingMoves(char square, uint64_t occupiedSquares, bool bishop) {
+    const char* xOffsets = bishop ? BISHOP_X_OFFSETS : ROOK_X_OFFSETS;
+    const char* yOffsets = bishop ? BISHOP_Y_OFFSETS : ROOK_Y_OFFSETS;
+    uint64_t moves = 0ull;
+    for (int direction = 0; direction < 4; direction++) {
+        moves |= calculateRay(square, occupiedSquares, xOffsets[direction], yOffsets[direction]);
+    }
+    return moves;
+}
+
+void AttackTables::getBlockerBitboards(uint64_t mask, vector<uint64_t>* blockerBitboards) {
+    //carry-rippler trick, which lists the subsets of the mask in the same order as the keys pext gives them
+    blockerBitboards->clear();
+    uint64_t blockerBitboard = 0ull;
+    do {
+        blockerBitboards->push_back(blockerBitboard);
+        blockerBitboard = (blockerBitboard - mask) & mask;
+    } while (blockerBitboard);
+}
+
+void AttackTables::initSlidingTable(magicEntry* magics, const uint64_t* magicNumbers, const int* shifts, bool bishop) {
+    vector<uint64_t> blockerBitboards;
+    for (char square = 0; square < 64; square++) {
+        magicEntry* entry = &magics[square];
+        entry->magic = magicNumbers[square];
+        entry->shift = shifts[square];
+        entry->mask = getBlockerMask(square, bishop);
+
+        //list every arrangement of blockers on the mask
+        getBlockerBitboards(entry->mask, &blockerBitboards);
+
+        //this square's section of the table only needs to be as big as the largest key generated by the magic number
+        //with pext, the blocker arrangements were listed in the order of their keys, so the key is just the position in the list
+        uint64_t maxKey = blockerBitboards.size() - 1;
+        if (!m_usePext) {
+            maxKey = 0ull;
+            for (uint64_t blockers : blockerBitboards) {
+                maxKey = max(maxKey, (blockers * entry->magic) >> entry->shift);
+            }
+        }
+
+        entry->moves = m_slidingMoves + m_slidingTableSize;
+        m_slidingTableSize += maxKey + 1;
+
+        for (size_t i = 0; i < blockerBitboards.size(); i++) {
+            uint64_t moves = calculateSlidingMoves(square, blockerBitboards[i], bishop);
+            entry->moves[m_usePext ? i : (blockerBitboards[i] * entry->magic) >> entry->shift] = moves;
+        }
+    }
+}
+
+//calculate the squares a sliding piece can move to in one direction, up to and including the first blocker
+uint64_t AttackTables::calculateRay(char square, uint64_t blockerBitboard, char xOffset, char yOffset) {
+    uint64_t ray = 0ull;
+    int x = square % 8 + xOffset;
+    int y = square / 8 + yOffset;
+    while ((x >= 0) && (x < 8) && (y >= 0) && (y < 8)) {
+        uint64_t squareBitboard = 1ull << (y * 8 + x);
+        ray |= squareBitboard;
+        if (squareBitboard & blockerBitboard) {
+            break;
+        }
+        x += xOffset;
+        y += yOffset;
+    }
+    return ray;
+}
\ No newline at end of file
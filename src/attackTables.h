@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+#include "constants.h"
+#include "bitboard.h"
+
+//the largest the sliding piece tables can be, if every square needed all of the keys its shift allows
+constexpr int getMaxSlidingTableSize() {
+    int size = 0;
+    for (int square = 0; square < 64; square++) {
+        size += 1 << (64 - constants::ROOK_SHIFTS[square]);
+        size += 1 << (64 - constants::BISHOP_SHIFTS[square]);
+    }
+    return size;
+}
+
+//the size of the sliding piece tables when they are indexed with pext, which is 2 to the power of the number of squares
+//that can block each piece, summed over all of the squares
+constexpr int PEXT_SLIDING_TABLE_SIZE = { 102400 + 5248 };
+
+struct magicEntry {
+    uint64_t* moves; //this square's section of the sliding piece table
+    uint64_t mask; //squares that can block the piece
+    uint64_t magic;
+    int shift;
+};
+
+//lookup tables that are the same for every board, so they are built once and shared by all of the boards and threads
+//the moves for every square of both sliding pieces are packed one after another into a single table, with each square
+//only taking up as many entries as its largest key needs ("fancy" magic bitboards)
+//on cpus with a fast pext instruction, the tables are indexed by extracting the blockers with pext instead of with magics
+class AttackTables {
+private:
+    alignas(64) uint64_t m_slidingMoves[std::max(getMaxSlidingTableSize(), PEXT_SLIDING_TABLE_SIZE)];
+    int m_slidingTableSize;
+    bool m_usePext;
+    magicEntry m_rookMagics[64];
+    magicEntry m_bishopMagics[64];
+
+    void initSlidingTable(magicEntry* magics, const uint64_t* magicNumbers, const int* shifts, bool bishop);
+    static uint64_t calculateRay(char square, uint64_t blockerBitboard, char xOffset, char yOffset);
+    static void readCpuInfo(bool* bmi2, bool* amd, unsigned int* family);
+
+    inline uint64_t getIndex(const magicEntry& entry, uint64_t occupiedSquares) const {
+#ifdef PEXT_AVAILABLE
+        if (m_usePext) {
+            return pext(occupiedSquares, entry.mask);
+        }
+#endif
+        return ((occupiedSquares & entry.mask) * entry.magic) >> entry.shift;
+    }
+
+public:
+    //usePext must only be true if the cpu supports bmi2
+    AttackTables(bool usePext);
+    AttackTables(const AttackTables&) = delete;
+    AttackTables& operator=(const AttackTables&) = delete;
+
+    //the tables are built the first time this is called, which is thread safe
+    static const AttackTables& get();
+
+    //squares that can block a rook or bishop on the square, which are the squares the magic numbers are multiplied by
+    static uint64_t getBlockerMask(char square, bool bishop);
+    //every arrangement of pieces on the blocker mask
+    static void getBlockerBitboards(uint64_t mask, std::vector<uint64_t>* blockerBitboards);
+    //squares a rook or bishop on the square can move to, worked out the slow way by walking along each direction
+    static uint64_t calculateSlidingMoves(char square, uint64_t occupiedSquares, bool bishop);
+
+    static bool isPextSupported();
+    //whether the cpu has a pext instruction that is faster than looking up magics
+    static bool isPextFast();
+
+    inline uint64_t getRookMoves(char square, uint64_t occupiedSquares) const {
+        const magicEntry& entry = m_rookMagics[square];
+        return entry.moves[getIndex(entry, occupiedSquares)];
+    }
+    inline uint64_t getBishopMoves(char square, uint64_t occupiedSquares) const {
+        const magicEntry& entry = m_bishopMagics[square];
+        return entry.moves[getIndex(entry, occupiedSquares)];
+    }
+    //number of bytes of the sliding piece table that are in use
+    inline int getSlidingTableBytes() const {
+        return m_slidingTableSize * sizeof(uint64_t);
+    }
+    inline bool usesPext() const {
+        return m_usePext;
+    }
+};
\ No newline at end of file
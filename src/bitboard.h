@@ -1,5 +1,8 @@
 #pragma once
 
+#include <bit>
+#include <cstdint>
+
 //bitboard manipulation
 inline unsigned long lsb(uint64_t bitboard) {
     unsigned long LSBbitboard;
@@ -8,9 +11,32 @@ inline unsigned long lsb(uint64_t bitboard) {
     return std::__countr_zero(bitboard);
 }
 
+//count the number of bits that are set
+inline int popcount(uint64_t bitboard) {
+    return std::__popcount(bitboard);
+}
+
 //remove the least significant bit and return which bit it was (0, 1, 2, 3, ...)
 inline int popLSB(uint64_t* bitboard) {
     const int square = lsb(*bitboard);
     *bitboard &= *bitboard - 1;
     return square;
-}
\ No newline at end of file
+}
+
+//parallel bit extract (bmi2), which gathers the bits of the bitboard under the mask into the lowest bits
+//this must only be called when the cpu supports bmi2
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PEXT_AVAILABLE
+//inline assembly is used instead of the intrinsic so that it can be inlined without building everything with -mbmi2
+inline uint64_t pext(uint64_t bitboard, uint64_t mask) {
+    uint64_t result;
+    asm("pextq %2, %1, %0" : "=r"(result) : "r"(bitboard), "rm"(mask));
+    return result;
+}
+#elif defined(_MSC_VER) && defined(_M_X64)
+#include <immintrin.h>
+#define PEXT_AVAILABLE
+inline uint64_t pext(uint64_t bitboard, uint64_t mask) {
+    return _pext_u64(bitboard, mask);
+}
+#endif
\ No newline at end of file
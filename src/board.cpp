@@ -8,6 +8,7 @@
 #include "board.h"
 #include "bitboard.h"
 #include "constants.h"
+#include "lookupTables.h"
 
 Board::Board() {
     for (unsigned char i = 0; i < 15; i++) {
@@ -24,11 +25,9 @@ Board::Board() {
     for (unsigned int i = 0; i < 4; i++) {
         m_castleRights[i] = true;
     }
+    setEvalTerms();
 
-    m_zobristKeys = new uint64_t[11800];
-
-    initPieceMovementMasksAndTables();
-    initZobristRandoms();
+    m_attackTables = &AttackTables::get();
 }
 
 void Board::loadFromFen(string fen) {
@@ -133,1465 +132,623 @@ void Board::loadFromFen(string fen) {
 
     //get the zobrist hash
     setZobristKey();
+
+    setEvalTerms();
+}
+
+void Board::makeMove(Move move) {
+    if (m_turn) {
+        makeMove<Color::Black>(move);
+    }
+    else {
+        makeMove<Color::White>(move);
+    }
+}
+
+//toggle a piece on or off a square, or between two squares, in the bitboards of its type, its side and the empty squares
+inline void Board::togglePiece(char piece, uint64_t squares) {
+    m_pieces[piece] ^= squares;
+    m_pieces[PieceType::White + (piece & 1)] ^= squares;
+    m_pieces[PieceType::All] ^= squares;
+}
+
+//add or remove a piece while making a move, updating the zobrist key, pawn key and evaluation terms as well
+inline void Board::addPiece(char piece, char square) {
+    togglePiece(piece, 1ull << square);
+    m_eightByEight[square] = piece;
+    m_zobristKeys[m_ply] ^= lookupTables::ZOBRIST_RANDOMS[piece * 64 + square];
+    m_pawnKey ^= lookupTables::ZOBRIST_RANDOMS[piece * 64 + square] * (piece >= PieceType::WhitePawn);
+    addPieceToEval(piece, square);
 }
 
-void Board::makeMove(unsigned char from, unsigned char to, unsigned char flags) {
-    //copy the zobrist key from the last position
-    m_zobristKeys[m_ply + 1] = m_zobristKeys[m_ply];
+inline void Board::removePiece(char piece, char square) {
+    togglePiece(piece, 1ull << square);
+    m_eightByEight[square] = PieceType::All;
+    m_zobristKeys[m_ply] ^= lookupTables::ZOBRIST_RANDOMS[piece * 64 + square];
+    m_pawnKey ^= lookupTables::ZOBRIST_RANDOMS[piece * 64 + square] * (piece >= PieceType::WhitePawn);
+    removePieceFromEval(piece, square);
+}
 
+inline void Board::movePiece(char piece, char from, char to) {
+    togglePiece(piece, (1ull << from) | (1ull << to));
+    m_eightByEight[from] = PieceType::All;
+    m_eightByEight[to] = piece;
+    m_zobristKeys[m_ply] ^= lookupTables::ZOBRIST_RANDOMS[piece * 64 + from] ^ lookupTables::ZOBRIST_RANDOMS[piece * 64 + to];
+    m_pawnKey ^= (lookupTables::ZOBRIST_RANDOMS[piece * 64 + from] ^ lookupTables::ZOBRIST_RANDOMS[piece * 64 + to]) * (piece >= PieceType::WhitePawn);
+    removePieceFromEval(piece, from);
+    addPieceToEval(piece, to);
+}
+
+template <Color Us>
+void Board::makeMove(Move move) {
+    constexpr int us = static_cast<int>(Us);
+    constexpr char kingStartSquare = Us == Color::White ? 60 : 4;
+
+    unsigned char from = getMoveFrom(move);
+    unsigned char to = getMoveTo(move);
+    unsigned char flags = getMoveFlags(move);
+    char piece = m_eightByEight[from];
+    char takenPiece = m_eightByEight[to];
+    bool pawnMove = piece == PieceType::WhitePawn + us;
+
+    //save everything that can't be worked out from the move when it is unmade
+    unMakeMoveState* state = &m_stateStack[m_ply % constants::STATE_STACK_SIZE];
+    state->enPassantBitboard = m_enPassantBitboard;
+    state->enPassantSquare = m_enPassantSquare;
+    state->takenPieceType = takenPiece;
+    state->lastTakeOrPawnMove = m_lastTakeOrPawnMove;
+    state->last50MoveRule = m_50MoveRule;
+    state->castleRights[0] = m_castleRights[0];
+    state->castleRights[1] = m_castleRights[1];
+    state->castleRights[2] = m_castleRights[2];
+    state->castleRights[3] = m_castleRights[3];
+    state->pawnKey = m_pawnKey;
+    state->material = m_material;
+    state->earlyGamePST = m_earlyGamePST;
+    state->endGamePST = m_endGamePST;
+    state->numPieces[0] = m_numPieces[0];
+    state->numPieces[1] = m_numPieces[1];
+
+    //copy the zobrist key from the last position, and apply the zobrist number to switch who's turn it is
+    m_zobristKeys[m_ply + 1] = m_zobristKeys[m_ply] ^ lookupTables::ZOBRIST_RANDOMS[768];
     m_ply++;
-    //apply the zobrist number to switch who's turn it is
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[768];
 
     //if the move was a take or a pawn move, update m_lastTakeOrPawnMove
-    bool takeOrPawnMove = (m_eightByEight[to] < 12) || (m_eightByEight[from] == PieceType::WhitePawn + m_turn);
+    bool takeOrPawnMove = (takenPiece < 12) || pawnMove;
     m_lastTakeOrPawnMove = m_lastTakeOrPawnMove * (!takeOrPawnMove) + (m_ply * takeOrPawnMove);
     //update 50 move rule counter
     m_50MoveRule = 0 * takeOrPawnMove + (m_50MoveRule + 1) * (!takeOrPawnMove);
 
-    //detect castling
-    bool castle[4];
-    castle[0] = m_castleRights[0] && (from == 60) && (to == 58);
-    castle[1] = m_castleRights[1] && (from == 60) && (to == 62);
-    castle[2] = m_castleRights[2] && (from == 4) && (to == 2);
-    castle[3] = m_castleRights[3] && (from == 4) && (to == 6);
-
-    //move rook when castling
-    if (castle[0] || castle[1] || castle[2] || castle[3]) {
-        uint64_t toggleBitboard = m_castlingRookToggleBitboards[0] * castle[0];
-        m_pieces[PieceType::WhiteRook] ^= toggleBitboard;
-        m_pieces[PieceType::All] ^= toggleBitboard;
-        m_eightByEight[56] = (PieceType::All * castle[0]) + (m_eightByEight[56] * !castle[0]);
-        m_eightByEight[59] = (m_eightByEight[59] * !castle[0]) + (PieceType::WhiteRook * castle[0]);
-        m_zobristKeys[m_ply] ^= m_zobristRandoms[PieceType::WhiteRook * 64 + 56] * castle[0];
-        m_zobristKeys[m_ply] ^= m_zobristRandoms[PieceType::WhiteRook * 64 + 59] * castle[0];
-        toggleBitboard = m_castlingRookToggleBitboards[1] * castle[1];
-        m_pieces[PieceType::WhiteRook] ^= toggleBitboard;
-        m_pieces[PieceType::All] ^= toggleBitboard;
-        m_eightByEight[63] = (PieceType::All * castle[1]) + (m_eightByEight[63] * !castle[1]);
-        m_eightByEight[61] = (m_eightByEight[61] * !castle[1]) + (PieceType::WhiteRook * castle[1]);
-        m_zobristKeys[m_ply] ^= m_zobristRandoms[PieceType::WhiteRook * 64 + 63] * castle[1];
-        m_zobristKeys[m_ply] ^= m_zobristRandoms[PieceType::WhiteRook * 64 + 61] * castle[1];
-        toggleBitboard = m_castlingRookToggleBitboards[2] * castle[2];
-        m_pieces[PieceType::BlackRook] ^= toggleBitboard;
-        m_pieces[PieceType::All] ^= toggleBitboard;
-        m_eightByEight[0] = (PieceType::All * castle[2]) + (m_eightByEight[0] * !castle[2]);
-        m_eightByEight[3] = (m_eightByEight[3] * !castle[2]) + (PieceType::BlackRook * castle[2]);
-        m_zobristKeys[m_ply] ^= m_zobristRandoms[PieceType::BlackRook * 64 + 0] * castle[2];
-        m_zobristKeys[m_ply] ^= m_zobristRandoms[PieceType::BlackRook * 64 + 3] * castle[2];
-        toggleBitboard = m_castlingRookToggleBitboards[3] * castle[3];
-        m_pieces[PieceType::BlackRook] ^= toggleBitboard;
-        m_pieces[PieceType::All] ^= toggleBitboard;
-        m_eightByEight[7] = (PieceType::All * castle[3]) + (m_eightByEight[7] * !castle[3]);
-        m_eightByEight[5] = (m_eightByEight[5] * !castle[3]) + (PieceType::BlackRook * castle[3]);
-        m_zobristKeys[m_ply] ^= m_zobristRandoms[PieceType::BlackRook * 64 + 7] * castle[3];
-        m_zobristKeys[m_ply] ^= m_zobristRandoms[PieceType::BlackRook * 64 + 5] * castle[3];
-        m_castled[0] |= castle[0] || castle[1];
-        m_castled[1] |= castle[2] || castle[3];
+    char enPassantSquare = 64;
+    if (flags) {
+        //promotion
+        if (takenPiece < 12) {
+            removePiece(takenPiece, to);
+            m_numPieces[!us]--;
+        }
+        removePiece(piece, from);
+        addPiece(flags + us, to);
+    }
+    else if ((piece == PieceType::WhiteKing + us) && (from == kingStartSquare) && ((to == from - 2) || (to == from + 2))) {
+        //castling, which moves the rook as well
+        const char rookFromSquares[4] = { 56, 63, 0, 7 };
+        const char rookToSquares[4] = { 59, 61, 3, 5 };
+        char castleType = 2 * us + (to > from);
+        movePiece(piece, from, to);
+        movePiece(PieceType::WhiteRook + us, rookFromSquares[castleType], rookToSquares[castleType]);
+        m_castled[us] = true;
+    }
+    else if (pawnMove && ((1ull << to) == m_enPassantBitboard)) {
+        //en passant, where the pawn that is taken isn't on the square being moved to
+        removePiece(PieceType::BlackPawn - us, m_enPassantSquare);
+        m_numPieces[!us]--;
+        movePiece(piece, from, to);
+    }
+    else {
+        if (takenPiece < 12) {
+            removePiece(takenPiece, to);
+            m_numPieces[!us]--;
+        }
+        movePiece(piece, from, to);
+        //a pawn that has just moved 2 spaces forward can be taken en passant
+        if (pawnMove && (((Us == Color::White) ? from - to : to - from) == 16)) {
+            enPassantSquare = to;
+        }
     }
 
     //update castling rights
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[769] * m_castleRights[0];
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[770] * m_castleRights[1];
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[771] * m_castleRights[2];
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[772] * m_castleRights[3];
+    m_zobristKeys[m_ply] ^= lookupTables::ZOBRIST_RANDOMS[769] * m_castleRights[0];
+    m_zobristKeys[m_ply] ^= lookupTables::ZOBRIST_RANDOMS[770] * m_castleRights[1];
+    m_zobristKeys[m_ply] ^= lookupTables::ZOBRIST_RANDOMS[771] * m_castleRights[2];
+    m_zobristKeys[m_ply] ^= lookupTables::ZOBRIST_RANDOMS[772] * m_castleRights[3];
 
     m_castleRights[0] = m_castleRights[0] && !((from == 56) || (to == 56) || (from == 60));
     m_castleRights[1] = m_castleRights[1] && !((from == 63) || (to == 63) || (from == 60));
     m_castleRights[2] = m_castleRights[2] && !((from == 0) || (to == 0) || (from == 4));
     m_castleRights[3] = m_castleRights[3] && !((from == 7) || (to == 7) || (from == 4));
 
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[769] * m_castleRights[0];
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[770] * m_castleRights[1];
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[771] * m_castleRights[2];
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[772] * m_castleRights[3];
-
-    //create mask for the square being moved to
-    uint64_t mask = 1ull << to;
-    uint64_t invertedMask = ~mask;
-
-    //detect en passant
-    bool enPassant = (mask == m_enPassantBitboard) && ((m_eightByEight[from] == PieceType::WhitePawn) || (m_eightByEight[from] == PieceType::BlackPawn));
-
-    //take en passant pawn
-    m_pieces[BlackPawn - m_turn] ^= (1ull << m_enPassantSquare) * enPassant;
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[64 * (PieceType::BlackPawn - m_turn) + m_enPassantSquare] * enPassant;
-    m_pieces[All] ^= (1ull << m_enPassantSquare) * enPassant;
-    m_eightByEight[m_enPassantSquare] = (PieceType::All * enPassant) + (m_eightByEight[m_enPassantSquare] * !enPassant);
-
-    //update bitboards for taken piece and piece being moved to square
-    m_pieces[m_eightByEight[to]] &= invertedMask;
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[64 * m_eightByEight[to] + to] * (m_eightByEight[to] < 12);
-    m_pieces[(m_eightByEight[from]) * !(flags) + !!(flags) * (flags + m_turn)] |= mask;
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[64 * ((m_eightByEight[from]) * !(flags) + !!(flags) * (flags + m_turn)) + to];
-
-    //create mask for the square being moved from
-    mask = 1ull << from;
-    invertedMask = ~mask;
-
-    //update bitboards for the piece being moved from the square (and the bitboard of empty squares)
-    m_pieces[m_eightByEight[from]] &= invertedMask;
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[64 * m_eightByEight[from] + from];
-    m_pieces[PieceType::All] |= mask;
-
-    //calculate whether a pawn has just moved 2 spaces forward
-    enPassant = ((m_eightByEight[from] == PieceType::WhitePawn) && ((from - to) == 16)) //if the pawn is white and has moved 2 spaces forward
-        || ((m_eightByEight[from] == PieceType::BlackPawn) && ((to - from) == 16)); //or the pawn is black and has moved to spaces forward
+    m_zobristKeys[m_ply] ^= lookupTables::ZOBRIST_RANDOMS[769] * m_castleRights[0];
+    m_zobristKeys[m_ply] ^= lookupTables::ZOBRIST_RANDOMS[770] * m_castleRights[1];
+    m_zobristKeys[m_ply] ^= lookupTables::ZOBRIST_RANDOMS[771] * m_castleRights[2];
+    m_zobristKeys[m_ply] ^= lookupTables::ZOBRIST_RANDOMS[772] * m_castleRights[3];
 
     //update en passant square and bitboard
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[773 + m_enPassantSquare % 8] * (m_enPassantSquare < 64);
-    m_enPassantSquare = (to * enPassant) + (64 * !enPassant);
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[773 + m_enPassantSquare % 8] * (m_enPassantSquare < 64);
-    m_enPassantBitboard = (1ull << (to + 8 - 16 * m_turn)) * enPassant; //location of en passant square (square that enemy pawn can move to to capture)
-
-    //update bitboards of all white and all black pieces
-    m_pieces[PieceType::White] = m_pieces[PieceType::WhiteBishop] | m_pieces[PieceType::WhiteKing] | m_pieces[PieceType::WhiteKnight] | m_pieces[PieceType::WhitePawn] | m_pieces[PieceType::WhiteQueen] | m_pieces[PieceType::WhiteRook];
-    m_pieces[PieceType::Black] = m_pieces[PieceType::BlackBishop] | m_pieces[PieceType::BlackKing] | m_pieces[PieceType::BlackKnight] | m_pieces[PieceType::BlackPawn] | m_pieces[PieceType::BlackQueen] | m_pieces[PieceType::BlackRook];
-
-    //update eight by eight board representation
-    m_eightByEight[to] = (m_eightByEight[from] * !flags) + (!!(flags) * (flags + m_turn));
-    m_eightByEight[from] = PieceType::All;
+    m_zobristKeys[m_ply] ^= lookupTables::ZOBRIST_RANDOMS[773 + m_enPassantSquare % 8] * (m_enPassantSquare < 64);
+    m_enPassantSquare = enPassantSquare;
+    m_zobristKeys[m_ply] ^= lookupTables::ZOBRIST_RANDOMS[773 + m_enPassantSquare % 8] * (m_enPassantSquare < 64);
+    m_enPassantBitboard = (1ull << (Us == Color::White ? to + 8 : to - 8)) * (enPassantSquare < 64); //location of en passant square (square that enemy pawn can move to to capture)
 
-    m_turn = !m_turn;
+    m_turn = !us;
 }
 
-void Board::unMakeMove(unsigned char from, unsigned char to, unsigned char flags, unMakeMoveState* prevBoardInfo) {
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[769] * m_castleRights[0];
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[770] * m_castleRights[1];
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[771] * m_castleRights[2];
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[772] * m_castleRights[3];
-
-    m_castleRights[0] = prevBoardInfo->castleRights[0];
-    m_castleRights[1] = prevBoardInfo->castleRights[1];
-    m_castleRights[2] = prevBoardInfo->castleRights[2];
-    m_castleRights[3] = prevBoardInfo->castleRights[3];
-
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[769] * m_castleRights[0];
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[770] * m_castleRights[1];
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[771] * m_castleRights[2];
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[772] * m_castleRights[3];
-
-    m_turn = !m_turn;
-
-    //update eight by eight board representation
-    m_eightByEight[from] = (m_eightByEight[to] * !flags) + (!(!flags) * (PieceType::WhitePawn + m_turn));
-    m_eightByEight[to] = prevBoardInfo->takenPieceType;
-
-    //update en passant square and bitboard
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[773 + m_enPassantSquare % 8] * (m_enPassantSquare < 64);
-    m_enPassantSquare = prevBoardInfo->enPassantSquare;
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[773 + m_enPassantSquare % 8] * (m_enPassantSquare < 64);
-    m_enPassantBitboard = prevBoardInfo->enPassantBitboard; //location of en passant square (square that enemy pawn can move to to capture)
-
-    //create mask for the square being moved from
-    uint64_t mask = 1ull << from;
-    uint64_t invertedMask = ~mask;
-
-    //update bitboards for the piece being moved from the square (and the bitboard of empty squares)
-    m_pieces[m_eightByEight[from]] |= mask;
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[64 * m_eightByEight[from] + from];
-    m_pieces[PieceType::All] &= invertedMask;
-
-    //create mask for the square being moved to
-    mask = 1ull << to;
-    invertedMask = ~mask;
-
-    //detect en passant
-    bool enPassant = (mask == m_enPassantBitboard) && ((m_eightByEight[from] == PieceType::WhitePawn) || (m_eightByEight[from] == PieceType::BlackPawn));
-
-    //un-take en passant pawn
-    m_pieces[BlackPawn - m_turn] ^= (1ull << m_enPassantSquare) * enPassant;
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[64 * (PieceType::BlackPawn - m_turn) + m_enPassantSquare] * enPassant;
-    m_pieces[All] ^= (1ull << m_enPassantSquare) * enPassant;
-    m_eightByEight[m_enPassantSquare] = ((PieceType::BlackPawn - m_turn) * enPassant) + (m_eightByEight[m_enPassantSquare] * !enPassant);
-
-    //update bitboards for taken piece and piece being moved to square
-    m_pieces[prevBoardInfo->takenPieceType] |= mask;
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[64 * prevBoardInfo->takenPieceType + to] * (m_eightByEight[to] < 12);
-    m_pieces[(m_eightByEight[from] * !flags) + (!(!flags) * (flags + m_turn))] &= invertedMask;
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[64 * ((m_eightByEight[from]) * !(flags)+!!(flags) * (flags + m_turn)) + to];
-
-    //detect castling
-    bool castle[4];
-    castle[0] = m_castleRights[0] && (from == 60) && (to == 58);
-    castle[1] = m_castleRights[1] && (from == 60) && (to == 62);
-    castle[2] = m_castleRights[2] && (from == 4) && (to == 2);
-    castle[3] = m_castleRights[3] && (from == 4) && (to == 6);
-
-    //move rook when castling
-    if (castle[0] || castle[1] || castle[2] || castle[3]) {
-        uint64_t toggleBitboard = m_castlingRookToggleBitboards[0] * castle[0];
-        m_pieces[PieceType::WhiteRook] ^= toggleBitboard;
-        m_pieces[PieceType::All] ^= toggleBitboard;
-        m_eightByEight[56] = (PieceType::WhiteRook * castle[0]) + (m_eightByEight[56] * !castle[0]);
-        m_eightByEight[59] = (m_eightByEight[59] * !castle[0]) + (PieceType::All * castle[0]);
-        m_zobristKeys[m_ply] ^= m_zobristRandoms[PieceType::WhiteRook * 64 + 56] * castle[0];
-        m_zobristKeys[m_ply] ^= m_zobristRandoms[PieceType::WhiteRook * 64 + 59] * castle[0];
-        toggleBitboard = m_castlingRookToggleBitboards[1] * castle[1];
-        m_pieces[PieceType::WhiteRook] ^= toggleBitboard;
-        m_pieces[PieceType::All] ^= toggleBitboard;
-        m_eightByEight[63] = (PieceType::WhiteRook * castle[1]) + (m_eightByEight[63] * !castle[1]);
-        m_eightByEight[61] = (m_eightByEight[61] * !castle[1]) + (PieceType::All * castle[1]);
-        m_zobristKeys[m_ply] ^= m_zobristRandoms[PieceType::WhiteRook * 64 + 63] * castle[1];
-        m_zobristKeys[m_ply] ^= m_zobristRandoms[PieceType::WhiteRook * 64 + 61] * castle[1];
-        toggleBitboard = m_castlingRookToggleBitboards[2] * castle[2];
-        m_pieces[PieceType::BlackRook] ^= toggleBitboard;
-        m_pieces[PieceType::All] ^= toggleBitboard;
-        m_eightByEight[0] = (PieceType::BlackRook * castle[2]) + (m_eightByEight[0] * !castle[2]);
-        m_eightByEight[3] = (m_eightByEight[3] * !castle[2]) + (PieceType::All * castle[2]);
-        m_zobristKeys[m_ply] ^= m_zobristRandoms[PieceType::BlackRook * 64 + 0] * castle[2];
-        m_zobristKeys[m_ply] ^= m_zobristRandoms[PieceType::BlackRook * 64 + 3] * castle[2];
-        toggleBitboard = m_castlingRookToggleBitboards[3] * castle[3];
-        m_pieces[PieceType::BlackRook] ^= toggleBitboard;
-        m_pieces[PieceType::All] ^= toggleBitboard;
-        m_eightByEight[7] = (PieceType::BlackRook * castle[3]) + (m_eightByEight[7] * !castle[3]);
-        m_eightByEight[5] = (m_eightByEight[5] * !castle[3]) + (PieceType::All * castle[3]);
-        m_zobristKeys[m_ply] ^= m_zobristRandoms[PieceType::BlackRook * 64 + 7] * castle[3];
-        m_zobristKeys[m_ply] ^= m_zobristRandoms[PieceType::BlackRook * 64 + 5] * castle[3];
-        m_castled[0] ^= castle[0] || castle[1];
-        m_castled[1] ^= castle[2] || castle[3];
+void Board::unMakeMove(Move move) {
+    //it is the turn of the side that didn't make the move
+    if (m_turn) {
+        unMakeMove<Color::White>(move);
     }
-
-    //update bitboards of all white and all black pieces
-    m_pieces[PieceType::White] = m_pieces[PieceType::WhiteBishop] | m_pieces[PieceType::WhiteKing] | m_pieces[PieceType::WhiteKnight] | m_pieces[PieceType::WhitePawn] | m_pieces[PieceType::WhiteQueen] | m_pieces[PieceType::WhiteRook];
-    m_pieces[PieceType::Black] = m_pieces[PieceType::BlackBishop] | m_pieces[PieceType::BlackKing] | m_pieces[PieceType::BlackKnight] | m_pieces[PieceType::BlackPawn] | m_pieces[PieceType::BlackQueen] | m_pieces[PieceType::BlackRook];
-
-    m_lastTakeOrPawnMove = prevBoardInfo->lastTakeOrPawnMove;
-    m_50MoveRule = prevBoardInfo->last50MoveRule;
-
-    m_ply--;
-}
-
-unsigned char Board::getSquareNum(unsigned char x, unsigned char y) {
-    return y * 8 + x;
-}
-
-void Board::generateRookMovementMasks(uint64_t* masks) {
-    char positionXoffsets[4] = { -1, 1, 0, 0 };
-    char positionYoffsets[4] = { 0, 0, -1, 1 };
-    //the position the rook needs to be in for there to be no more moves when traveling in that direction:
-    char xLimits[4] = { 0, 7, 8, 8 };
-    char yLimits[4] = { 8, 8, 0, 7 };
-    for (char square = 0; square < 64; square++) {
-        uint64_t mask = 0;
-        int position[2];
-        for (unsigned char direction = 0; direction < 4; direction++) {
-            position[0] = square % 8;
-            position[1] = square / 8;
-            if ((xLimits[direction] == position[0]) || (yLimits[direction] == position[1])) {
-                position[0] -= positionXoffsets[direction];
-                position[1] -= positionYoffsets[direction];
-            }
-            position[0] += positionXoffsets[direction];
-            position[1] += positionYoffsets[direction];
-            while (!((xLimits[direction] == position[0]) || (yLimits[direction] == position[1]))) {
-                char squareNum = getSquareNum(position[0], position[1]);
-                mask |= 1ull << squareNum;
-
-                position[0] += positionXoffsets[direction];
-                position[1] += positionYoffsets[direction];
-            }
-        }
-
-        masks[square] = mask;
+    else {
+        unMakeMove<Color::Black>(move);
     }
 }
 
-void Board::generateBishopMovementMasks(uint64_t* masks) {
-    char positionXoffsets[4] = { -1, 1, -1, 1 };
-    char positionYoffsets[4] = { -1, -1, 1, 1 };
-    //the position the bishop needs to be in for there to be no more moves when traveling in that direction:
-    char xLimits[4] = { 0, 7, 0, 7 };
-    char yLimits[4] = { 0, 0, 7, 7 };
-    for (char square = 0; square < 64; square++) {
-        uint64_t mask = 0;
-        int position[2];
-        for (unsigned char direction = 0; direction < 4; direction++) {
-            position[0] = square % 8;
-            position[1] = square / 8;
-            if ((xLimits[direction] == position[0]) || (yLimits[direction] == position[1])) {
-                position[0] -= positionXoffsets[direction];
-                position[1] -= positionYoffsets[direction];
-            }
-            position[0] += positionXoffsets[direction];
-            position[1] += positionYoffsets[direction];
-            while (!((xLimits[direction] == position[0]) || (yLimits[direction] == position[1]))) {
-                char squareNum = getSquareNum(position[0], position[1]);
-                mask |= 1ull << squareNum;
-
-                position[0] += positionXoffsets[direction];
-                position[1] += positionYoffsets[direction];
-            }
-        }
+//the zobrist keys of earlier plies are never changed, and everything else that can't be worked out from the move is
+//popped off the state stack, so only the pieces have to be moved back
+template <Color Us>
+void Board::unMakeMove(Move move) {
+    constexpr int us = static_cast<int>(Us);
+    constexpr char kingStartSquare = Us == Color::White ? 60 : 4;
 
-        masks[square] = mask;
-    }
-}
-
-uint64_t* Board::createAllBlockerBitboards(uint64_t movementMask, int* numBlockerBitboards) {
-    //create a list of all the squares that the piece can move to according to the movement mask
-    vector<unsigned char> moveSquareIndices;
-    for (unsigned char square = 0; square < 64; square++) {
-        if (movementMask & (1ull << square)) {
-            moveSquareIndices.push_back(square);
-        }
-    }
+    m_ply--;
+    const unMakeMoveState* state = &m_stateStack[m_ply % constants::STATE_STACK_SIZE];
 
-    //calculate the total number of bitboards possible for the number of squares it can move to (2^n)
-    *numBlockerBitboards = 1u << moveSquareIndices.size();
+    unsigned char from = getMoveFrom(move);
+    unsigned char to = getMoveTo(move);
+    unsigned char flags = getMoveFlags(move);
+    char piece = m_eightByEight[to];
+    char takenPiece = state->takenPieceType;
 
-    //create all the bitboards
-    uint64_t* blockerBitboards = new uint64_t[*numBlockerBitboards];
-    for (int bitboardIndex = 0; bitboardIndex < *numBlockerBitboards; bitboardIndex++) {
-        blockerBitboards[bitboardIndex] = 0ull;
-        for (unsigned char bitIndex = 0; bitIndex < moveSquareIndices.size(); bitIndex++) {
-            uint64_t bit = (static_cast<uint64_t>(bitboardIndex) >> bitIndex) & 1ull;
-            blockerBitboards[bitboardIndex] |= bit << moveSquareIndices[bitIndex];
-        }
+    if (flags) {
+        //promotion
+        togglePiece(piece, 1ull << to);
+        togglePiece(PieceType::WhitePawn + us, 1ull << from);
+        m_eightByEight[from] = PieceType::WhitePawn + us;
+        m_eightByEight[to] = takenPiece;
+        if (takenPiece < 12) {
+            togglePiece(takenPiece, 1ull << to);
+        }
+    }
+    else if ((piece == PieceType::WhiteKing + us) && (from == kingStartSquare) && ((to == from - 2) || (to == from + 2))) {
+        //castling
+        const char rookFromSquares[4] = { 56, 63, 0, 7 };
+        const char rookToSquares[4] = { 59, 61, 3, 5 };
+        char castleType = 2 * us + (to > from);
+        togglePiece(piece, (1ull << from) | (1ull << to));
+        togglePiece(PieceType::WhiteRook + us, lookupTables::CASTLING_ROOK_TOGGLES[castleType]);
+        m_eightByEight[from] = piece;
+        m_eightByEight[to] = PieceType::All;
+        m_eightByEight[rookFromSquares[castleType]] = PieceType::WhiteRook + us;
+        m_eightByEight[rookToSquares[castleType]] = PieceType::All;
+        m_castled[us] = false;
+    }
+    else if ((piece == PieceType::WhitePawn + us) && ((1ull << to) == state->enPassantBitboard)) {
+        //en passant
+        togglePiece(piece, (1ull << from) | (1ull << to));
+        togglePiece(PieceType::BlackPawn - us, 1ull << state->enPassantSquare);
+        m_eightByEight[from] = piece;
+        m_eightByEight[to] = PieceType::All;
+        m_eightByEight[state->enPassantSquare] = PieceType::BlackPawn - us;
     }
-
-    return blockerBitboards;
-}
-
-//function to find a magic number for a given set of blocker bitboards and legal moves
-void Board::calculateMagic(uint64_t* magic, char* shift, uint64_t* blockerBitboards, int numBlockerBitboards, uint64_t* keys, uint64_t* fullPieceMoves) {
-    bool magicFound = false;
-    uint64_t testMagic, testMagic2, r30, s30, t4;
-    //generate random 64 bit unsigned integer
-    r30 = RAND_MAX * rand() + rand();
-    s30 = RAND_MAX * rand() + rand();
-    t4 = rand() & 0xf;
-    testMagic = (s30 << 34) + (r30 << 4) + t4;
-
-    r30 = RAND_MAX * rand() + rand();
-    s30 = RAND_MAX * rand() + rand();
-    t4 = rand() & 0xf;
-    testMagic2 = (s30 << 34) + (r30 << 4) + t4;
-
-    testMagic = testMagic & testMagic2;
-
-    r30 = RAND_MAX * rand() + rand();
-    s30 = RAND_MAX * rand() + rand();
-    t4 = rand() & 0xf;
-    testMagic2 = (s30 << 34) + (r30 << 4) + t4;
-
-    testMagic = testMagic & testMagic2;
-
-    char minTestShift = *shift;
-    char testShift = minTestShift;
-    magicFound = true;
-    while (magicFound) {
-        for (int blockerBitboard = 0; blockerBitboard < numBlockerBitboards; blockerBitboard++) {
-            //calculate the key that will be used as an index
-            keys[blockerBitboard] = (blockerBitboards[blockerBitboard] * testMagic) >> testShift;
-            //shift the key left, and use the least significant bits to store the index of the blockerbitboard
-            keys[blockerBitboard] = keys[blockerBitboard] << testShift;
-            keys[blockerBitboard] |= blockerBitboard;
-        }
-
-        //check if the magic number works
-        std::sort(keys, keys + numBlockerBitboards);
-
-        uint64_t lastKey = keys[0];
-        for (int key = 1; key < numBlockerBitboards; key++) {
-            if ((keys[key] >> testShift) == (lastKey >> testShift)) {
-                //if they have the same key, check if they also have the same legal moves, if they do, then the magic still works
-                if (fullPieceMoves[(keys[key] << 32) >> 32] != fullPieceMoves[(lastKey << 32) >> 32]) {
-                    magicFound = false;
-                    break;
-                }
-            }
-            lastKey = keys[key];
-        }
-
-        testShift++;
+    else {
+        togglePiece(piece, (1ull << from) | (1ull << to));
+        m_eightByEight[from] = piece;
+        m_eightByEight[to] = takenPiece;
+        if (takenPiece < 12) {
+            togglePiece(takenPiece, 1ull << to);
+        }
+    }
+
+    m_turn = us;
+    m_enPassantBitboard = state->enPassantBitboard;
+    m_enPassantSquare = state->enPassantSquare;
+    m_lastTakeOrPawnMove = state->lastTakeOrPawnMove;
+    m_50MoveRule = state->last50MoveRule;
+    m_castleRights[0] = state->castleRights[0];
+    m_castleRights[1] = state->castleRights[1];
+    m_castleRights[2] = state->castleRights[2];
+    m_castleRights[3] = state->castleRights[3];
+    m_pawnKey = state->pawnKey;
+    m_material = state->material;
+    m_earlyGamePST = state->earlyGamePST;
+    m_endGamePST = state->endGamePST;
+    m_numPieces[0] = state->numPieces[0];
+    m_numPieces[1] = state->numPieces[1];
+}
+
+void Board::getLegalMoves(MoveList* moves) {
+    if (m_turn) {
+        generateMoves<Color::Black, MoveType::AllMoves>(moves);
     }
-
-    if (testShift - 2 > minTestShift) {
-        if (testShift - 2 > *shift) {
-            *magic = testMagic;
-            *shift = testShift - 2;
-        }
-        magicFound = true;
+    else {
+        generateMoves<Color::White, MoveType::AllMoves>(moves);
     }
 }
 
-void Board::createRookLookupTable() {
-    int numBlockerBitboards;
-    uint64_t* blockerBitboards;
-
-    int numKeys = 0;
-    for (int square = 0; square < 64; square++) {
-        //generate all possible piece arrangements for the mask
-        blockerBitboards = createAllBlockerBitboards(m_rookMovementMasks[square], &numBlockerBitboards);
-
-        //find the largest key generated by the magic number - this will be the size of the table for this square
-        uint64_t maxKey = 0ull;
-        uint64_t key;
-        for (int blockerBitboard = 0; blockerBitboard < numBlockerBitboards; blockerBitboard++) {
-            key = (blockerBitboards[blockerBitboard] * constants::ROOK_MAGICS[square]) >> constants::ROOK_SHIFTS[square];
-            if (key > maxKey) {
-                maxKey = key;
-            }
-        }
-        numKeys += maxKey + 1;
-
-        //set up the array of move bitboards
-        m_rookMovesLookup[square] = new uint64_t[maxKey + 1];//1ull << (64 - constants::ROOK_SHIFTS[square])];
-
-        //generate all legal moves for each blockerBitboard
-        for (int blockerBitboard = 0; blockerBitboard < numBlockerBitboards; blockerBitboard++) {
-            key = (blockerBitboards[blockerBitboard] * constants::ROOK_MAGICS[square]) >> constants::ROOK_SHIFTS[square];
-            m_rookMovesLookup[square][key] = calculateRookMoves(square, blockerBitboards[blockerBitboard]);
-        }
-
-        delete[] blockerBitboards;
+void Board::prepareMoveGeneration() {
+    if (m_turn) {
+        updateAttackingSquares<Color::Black>();
+        updatePinnedPieces<Color::Black>();
     }
-    //cout << numKeys << endl;
-}
-
-void Board::createBishopLookupTable() {
-    int numBlockerBitboards;
-    uint64_t* blockerBitboards;
-
-    int numKeys = 0;
-    for (int square = 0; square < 64; square++) {
-        //generate all possible piece arrangements for the mask
-        blockerBitboards = createAllBlockerBitboards(m_bishopMovementMasks[square], &numBlockerBitboards);
-
-        //find the largest key generated by the magic number - this will be the size of the table for this square
-        uint64_t maxKey = 0ull;
-        uint64_t key;
-        for (int blockerBitboard = 0; blockerBitboard < numBlockerBitboards; blockerBitboard++) {
-            key = (blockerBitboards[blockerBitboard] * constants::BISHOP_MAGICS[square]) >> constants::BISHOP_SHIFTS[square];
-            if (key > maxKey) {
-                maxKey = key;
-            }
-        }
-        numKeys += maxKey + 1;
-
-        //set up the array of move bitboards
-        m_bishopMovesLookup[square] = new uint64_t[maxKey + 1];//1ull << (64 - constants::ROOK_SHIFTS[square])];
-
-        //generate all legal moves for each blockerBitboard
-        for (int blockerBitboard = 0; blockerBitboard < numBlockerBitboards; blockerBitboard++) {
-            key = (blockerBitboards[blockerBitboard] * constants::BISHOP_MAGICS[square]) >> constants::BISHOP_SHIFTS[square];
-            m_bishopMovesLookup[square][key] = calculateBishopMoves(square, blockerBitboards[blockerBitboard]);
-        }
-
-        delete[] blockerBitboards;
+    else {
+        updateAttackingSquares<Color::White>();
+        updatePinnedPieces<Color::White>();
     }
-    //cout << numKeys << endl;
 }
 
-uint64_t Board::calculateRookMoves(unsigned char rookPosition, uint64_t blockerBitboard) {
-    char positionXoffsets[4] = { -1, 1, 0, 0 };
-    char positionYoffsets[4] = { 0, 0, -1, 1 };
-    //the position the rook needs to be in for there to be no more moves when traveling in that direction:
-    char xLimits[4] = { 0, 7, 8, 8 };
-    char yLimits[4] = { 8, 8, 0, 7 };
-    uint64_t currentSquareBitboard;
-    uint64_t mask = 0ull;
-    int position[2];
-    for (unsigned char direction = 0; direction < 4; direction++) {
-        position[0] = rookPosition % 8;
-        position[1] = rookPosition / 8;
-        while (!((xLimits[direction] == position[0]) || (yLimits[direction] == position[1]))) {
-            position[0] += positionXoffsets[direction];
-            position[1] += positionYoffsets[direction];
-
-            char squareNum = getSquareNum(position[0], position[1]);
-            currentSquareBitboard = 1ull << squareNum;
-            mask |= currentSquareBitboard;
-
-            if (currentSquareBitboard & blockerBitboard) {
-                break;
-            }
-        }
-    }
-
-    return mask;
+void Board::saveMoveGenerationState(moveGenerationState* state) {
+    state->attackingSquares = m_attackingSquares;
+    state->pinnedPieces = m_pinnedPieces;
+    state->checkers = m_checkers;
+    state->blockOrCaptureCheckMask = m_blockOrCaptureCheckMask;
+    state->check = m_check;
+    state->doubleCheck = m_doubleCheck;
+    state->checkingPiece = m_checkingPiece;
 }
 
-uint64_t Board::calculateBishopMoves(unsigned char bishopPosition, uint64_t blockerBitboard) {
-    char positionXoffsets[4] = { -1, 1, -1, 1 };
-    char positionYoffsets[4] = { -1, -1, 1, 1 };
-    //the position the rook needs to be in for there to be no more moves when traveling in that direction:
-    char xLimits[4] = { 0, 7, 0, 7 };
-    char yLimits[4] = { 0, 0, 7, 7 };
-    uint64_t currentSquareBitboard;
-    uint64_t mask = 0ull;
-    int position[2];
-    for (unsigned char direction = 0; direction < 4; direction++) {
-        position[0] = bishopPosition % 8;
-        position[1] = bishopPosition / 8;
-        while (!((xLimits[direction] == position[0]) || (yLimits[direction] == position[1]))) {
-            position[0] += positionXoffsets[direction];
-            position[1] += positionYoffsets[direction];
-
-            char squareNum = getSquareNum(position[0], position[1]);
-            currentSquareBitboard = 1ull << squareNum;
-            mask |= currentSquareBitboard;
-
-            if (currentSquareBitboard & blockerBitboard) {
-                break;
-            }
-        }
-    }
-
-    return mask;
+void Board::restoreMoveGenerationState(const moveGenerationState* state) {
+    m_attackingSquares = state->attackingSquares;
+    m_pinnedPieces = state->pinnedPieces;
+    m_checkers = state->checkers;
+    m_blockOrCaptureCheckMask = state->blockOrCaptureCheckMask;
+    m_check = state->check;
+    m_doubleCheck = state->doubleCheck;
+    m_checkingPiece = state->checkingPiece;
 }
 
-void Board::initPieceMovementMasksAndTables() {
-    generateRookMovementMasks(m_rookMovementMasks);
-    generateBishopMovementMasks(m_bishopMovementMasks);
-
-    createRookLookupTable();
-    createBishopLookupTable();
-
-    calculatePawnMoves();
-    calculateKnightMoves();
-    calculateKingMoves();
-
-    initCastlingBitboards();
-
-    calculateAlignMasks();
-}
-
-//super inefficient subroutine but as it only runs once at the start of the program I'm keeping it simple
-void Board::calculatePawnMoves() {
-    //pawn 1 forward moves
-    for (int square = 8; square < 64; square++) {
-        m_whitePawn1ForwardMoves[square] = 1ull << (square - 8);
-    }
-    for (int square = 0; square < 8; square++) {
-        m_whitePawn1ForwardMoves[square] = 0ull;
-    }
-    for (int square = 0; square < 56; square++) {
-        m_blackPawn1ForwardMoves[square] = 1ull << (square + 8);
-    }
-    for (int square = 56; square < 64; square++) {
-        m_blackPawn1ForwardMoves[square] = 0ull;
-    }
-    //pawn 2 forward moves
-    for (int square = 48; square < 56; square++) {
-        m_whitePawn2ForwardMoves[square] = 1ull << (square - 16);
-    }
-    for (int square = 56; square < 64; square++) {
-        m_whitePawn2ForwardMoves[square] = 0ull;
+void Board::getCaptureMoves(MoveList* moves) {
+    if (m_turn) {
+        generateMoves<Color::Black, MoveType::Captures>(moves);
     }
-    for (int square = 0; square < 48; square++) {
-        m_whitePawn2ForwardMoves[square] = 0ull;
-    }
-    for (int square = 8; square < 16; square++) {
-        m_blackPawn2ForwardMoves[square] = 1ull << (square + 16);
-    }
-    for (int square = 0; square < 8; square++) {
-        m_blackPawn2ForwardMoves[square] = 0ull;
-    }
-    for (int square = 16; square < 64; square++) {
-        m_blackPawn2ForwardMoves[square] = 0ull;
-    }
-    //pawn takes
-    for (int square = 8; square < 64; square++) {
-        m_whitePawnTakesMoves[square] = 0ull;
-        if ((square % 8) > 0) {
-            m_whitePawnTakesMoves[square] |= 1ull << (square - 9);
-        }
-        if ((square % 8) < 7) {
-            m_whitePawnTakesMoves[square] |= 1ull << (square - 7);
-        }
-    }
-    for (int square = 0; square < 8; square++) {
-        m_blackPawnTakesMoves[square] = 0ull;
-    }
-    for (int square = 8; square < 64; square++) {
-        m_blackPawnTakesMoves[square] = 0ull;
-        if ((square % 8) > 0) {
-            m_blackPawnTakesMoves[square] |= 1ull << (square + 7);
-        }
-        if ((square % 8) < 7) {
-            m_blackPawnTakesMoves[square] |= 1ull << (square + 9);
-        }
-    }
-    for (int square = 0; square < 8; square++) {
-        m_blackPawnTakesMoves[square] = 0ull;
-    }
-    //en passant
-    for (int square = 0; square < 64; square++) {
-        m_whitePawnEnPassantMoves[square] = 0ull;
-    }
-    for (int square = 24; square < 31; square++) {
-        m_whitePawnEnPassantMoves[square] |= 1ull << (square - 7);
-    }
-    for (int square = 25; square < 32; square++) {
-        m_whitePawnEnPassantMoves[square] |= 1ull << (square - 9);
-    }
-    for (int square = 0; square < 64; square++) {
-        m_blackPawnEnPassantMoves[square] = 0ull;
-    }
-    for (int square = 32; square < 39; square++) {
-        m_blackPawnEnPassantMoves[square] |= 1ull << (square + 9);
-    }
-    for (int square = 33; square < 40; square++) {
-        m_blackPawnEnPassantMoves[square] |= 1ull << (square + 7);
+    else {
+        generateMoves<Color::White, MoveType::Captures>(moves);
     }
 }
 
-void Board::calculateKnightMoves() {
-    for (int square = 0; square < 64; square++) {
-        m_knightMoves[square] = 0ull;
-        int rank = square / 8;
-        int file = square % 8;
-        if ((rank < 6) && (file < 7)) {
-            m_knightMoves[square] |= 1ull << (square + 17);
-        }
-        if ((rank < 7) && (file < 6)) {
-            m_knightMoves[square] |= 1ull << (square + 10);
-        }
-        if ((rank > 0) && (file < 6)) {
-            m_knightMoves[square] |= 1ull << (square - 6);
-        }
-        if ((rank > 1) && (file < 7)) {
-            m_knightMoves[square] |= 1ull << (square - 15);
-        }
-        if ((rank > 1) && (file > 0)) {
-            m_knightMoves[square] |= 1ull << (square - 17);
-        }
-        if ((rank > 0) && (file > 1)) {
-            m_knightMoves[square] |= 1ull << (square - 10);
-        }
-        if ((rank < 7) && (file > 1)) {
-            m_knightMoves[square] |= 1ull << (square + 6);
-        }
-        if ((rank < 6) && (file > 0)) {
-            m_knightMoves[square] |= 1ull << (square + 15);
-        }
+//generate the legal moves that don't take a piece, which includes castling, en passant and promotions to an empty square
+//together with the capture moves, these make up all of the legal moves
+void Board::getQuietMoves(MoveList* moves) {
+    if (m_turn) {
+        generateMoves<Color::Black, MoveType::Quiets>(moves);
     }
-}
-
-void Board::calculateKingMoves() {
-    for (int square = 0; square < 64; square++) {
-        m_kingMoves[square] = 0ull;
-        int rank = square / 8;
-        int file = square % 8;
-        if (rank < 7) {
-            m_kingMoves[square] |= 1ull << (square + 8);
-        }
-        if ((rank < 7) && (file < 7)) {
-            m_kingMoves[square] |= 1ull << (square + 9);
-        }
-        if (file < 7) {
-            m_kingMoves[square] |= 1ull << (square + 1);
-        }
-        if ((rank > 0) && (file < 7)) {
-            m_kingMoves[square] |= 1ull << (square - 7);
-        }
-        if (rank > 0) {
-            m_kingMoves[square] |= 1ull << (square - 8);
-        }
-        if ((rank > 0) && (file > 0)) {
-            m_kingMoves[square] |= 1ull << (square - 9);
-        }
-        if ((file > 0)) {
-            m_kingMoves[square] |= 1ull << (square - 1);
-        }
-        if ((file > 0) && (rank < 7)) {
-            m_kingMoves[square] |= 1ull << (square + 7);
-        }
+    else {
+        generateMoves<Color::White, MoveType::Quiets>(moves);
     }
 }
 
-void Board::initCastlingBitboards() {
-    m_castlingEmptySquareBitboards[2] = 14ull;
-    m_castlingEmptySquareBitboards[3] = 96ull;
-    m_castlingEmptySquareBitboards[0] = 14ull << 56;
-    m_castlingEmptySquareBitboards[1] = 96ull << 56;
-
-    m_castlingRookToggleBitboards[2] = 9ull;
-    m_castlingRookToggleBitboards[3] = 160ull;
-    m_castlingRookToggleBitboards[0] = 9ull << 56;
-    m_castlingRookToggleBitboards[1] = 160ull << 56;
-
-    m_castlingAttackingSquareBitboards[2] = 28ull;
-    m_castlingAttackingSquareBitboards[3] = 112ull;
-    m_castlingAttackingSquareBitboards[0] = 28ull << 56;
-    m_castlingAttackingSquareBitboards[1] = 112ull << 56;
-}
-
-uint64_t Board::getRookLegalMoves(char square) {
-    uint64_t blockerBitboard = (~m_pieces[PieceType::All]) & m_rookMovementMasks[square];
-    uint64_t key = (blockerBitboard * constants::ROOK_MAGICS[square]) >> constants::ROOK_SHIFTS[square];
-    return m_rookMovesLookup[square][key] & (~m_pieces[PieceType::White + m_turn]);
-}
-
-uint64_t Board::getRookLegalMovesCapturesOnly(char square) {
-    uint64_t blockerBitboard = (~m_pieces[PieceType::All]) & m_rookMovementMasks[square];
-    uint64_t key = (blockerBitboard * constants::ROOK_MAGICS[square]) >> constants::ROOK_SHIFTS[square];
-    return m_rookMovesLookup[square][key] & (~m_pieces[PieceType::White + m_turn]) & m_pieces[PieceType::Black - m_turn];
-}
-
-uint64_t Board::getRookAttacks(char square) {
-    uint64_t blockerBitboard = ((~m_pieces[PieceType::All]) ^ m_pieces[PieceType::WhiteKing + m_turn]) & m_rookMovementMasks[square];
-    uint64_t key = (blockerBitboard * constants::ROOK_MAGICS[square]) >> constants::ROOK_SHIFTS[square];
-    return m_rookMovesLookup[square][key];
-}
-
-uint64_t Board::getBishopLegalMoves(char square) {
-    uint64_t blockerBitboard = (~m_pieces[PieceType::All]) & m_bishopMovementMasks[square];
-    uint64_t key = (blockerBitboard * constants::BISHOP_MAGICS[square]) >> constants::BISHOP_SHIFTS[square];
-    return m_bishopMovesLookup[square][key] & (~m_pieces[PieceType::White + m_turn]);
-}
-
-uint64_t Board::getBishopLegalMovesCapturesOnly(char square) {
-    uint64_t blockerBitboard = (~m_pieces[PieceType::All]) & m_bishopMovementMasks[square];
-    uint64_t key = (blockerBitboard * constants::BISHOP_MAGICS[square]) >> constants::BISHOP_SHIFTS[square];
-    return m_bishopMovesLookup[square][key] & (~m_pieces[PieceType::White + m_turn]) & m_pieces[PieceType::Black - m_turn];
-}
+template <Color Us, MoveType Type>
+void Board::generateMoves(MoveList* moves) {
+    constexpr int us = static_cast<int>(Us);
 
-uint64_t Board::getBishopAttacks(char square) {
-    uint64_t blockerBitboard = ((~m_pieces[PieceType::All]) ^ m_pieces[PieceType::WhiteKing + m_turn]) & m_bishopMovementMasks[square];
-    uint64_t key = (blockerBitboard * constants::BISHOP_MAGICS[square]) >> constants::BISHOP_SHIFTS[square];
-    return m_bishopMovesLookup[square][key];
-}
-
-uint64_t Board::getQueenLegalMoves(char square) {
-    uint64_t allPiecesBitboard = ~m_pieces[PieceType::All];
-    uint64_t rookBlockerBitboard = allPiecesBitboard & m_rookMovementMasks[square];
-    uint64_t rookKey = (rookBlockerBitboard * constants::ROOK_MAGICS[square]) >> constants::ROOK_SHIFTS[square];
-    uint64_t bishopBlockerBitboard = allPiecesBitboard & m_bishopMovementMasks[square];
-    uint64_t bishopKey = (bishopBlockerBitboard * constants::BISHOP_MAGICS[square]) >> constants::BISHOP_SHIFTS[square];
-    return (m_rookMovesLookup[square][rookKey] | m_bishopMovesLookup[square][bishopKey]) & (~m_pieces[PieceType::White + m_turn]);
-}
-
-uint64_t Board::getQueenLegalMovesCapturesOnly(char square) {
-    uint64_t allPiecesBitboard = ~m_pieces[PieceType::All];
-    uint64_t rookBlockerBitboard = allPiecesBitboard & m_rookMovementMasks[square];
-    uint64_t rookKey = (rookBlockerBitboard * constants::ROOK_MAGICS[square]) >> constants::ROOK_SHIFTS[square];
-    uint64_t bishopBlockerBitboard = allPiecesBitboard & m_bishopMovementMasks[square];
-    uint64_t bishopKey = (bishopBlockerBitboard * constants::BISHOP_MAGICS[square]) >> constants::BISHOP_SHIFTS[square];
-    return (m_rookMovesLookup[square][rookKey] | m_bishopMovesLookup[square][bishopKey]) & (~m_pieces[PieceType::White + m_turn]) & m_pieces[PieceType::Black - m_turn];
-}
-
-uint64_t Board::getQueenAttacks(char square) {
-    uint64_t allPiecesBitboard = (~m_pieces[PieceType::All]) ^ m_pieces[PieceType::WhiteKing + m_turn];
-    uint64_t rookBlockerBitboard = allPiecesBitboard & m_rookMovementMasks[square];
-    uint64_t rookKey = (rookBlockerBitboard * constants::ROOK_MAGICS[square]) >> constants::ROOK_SHIFTS[square];
-    uint64_t bishopBlockerBitboard = allPiecesBitboard & m_bishopMovementMasks[square];
-    uint64_t bishopKey = (bishopBlockerBitboard * constants::BISHOP_MAGICS[square]) >> constants::BISHOP_SHIFTS[square];
-    return (m_rookMovesLookup[square][rookKey] | m_bishopMovesLookup[square][bishopKey]);
-}
-
-uint64_t Board::getWhitePawnLegalMoves(char square, char kingPosition) {
-    uint64_t pieceMoves = m_whitePawn1ForwardMoves[square] & m_pieces[PieceType::All];
-    pieceMoves |= m_whitePawn2ForwardMoves[square] & m_pieces[PieceType::All] & (pieceMoves >> 8);
-    pieceMoves |= m_whitePawnTakesMoves[square] & m_pieces[PieceType::Black];
-    pieceMoves |= (m_whitePawnEnPassantMoves[square] & m_enPassantBitboard) * !inCheckAfterEnPassant(square, kingPosition);
-    return pieceMoves;
-}
-
-uint64_t Board::getWhitePawnLegalMovesCapturesOnly(char square, char kingPosition) {
-    uint64_t pieceMoves = m_whitePawn1ForwardMoves[square] & m_pieces[PieceType::All];
-    pieceMoves |= m_whitePawn2ForwardMoves[square] & m_pieces[PieceType::All] & (pieceMoves >> 8);
-    pieceMoves |= m_whitePawnTakesMoves[square] & m_pieces[PieceType::Black];
-    pieceMoves |= (m_whitePawnEnPassantMoves[square] & m_enPassantBitboard) * !inCheckAfterEnPassant(square, kingPosition);
-    return pieceMoves & m_pieces[PieceType::Black - m_turn];
-}
+    //the staged generators share the attacks and pins from prepareMoveGeneration()
+    if constexpr (Type == MoveType::AllMoves) {
+        updateAttackingSquares<Us>();
+        updatePinnedPieces<Us>();
+    }
 
-uint64_t Board::getWhitePawnAttacks(char square) {
-    uint64_t pieceMoves = m_whitePawnTakesMoves[square];
-    return pieceMoves;
-}
+    char kingPosition = lsb(m_pieces[PieceType::WhiteKing + us]);
 
-uint64_t Board::getBlackPawnLegalMoves(char square, char kingPosition) {
-    uint64_t pieceMoves = m_blackPawn1ForwardMoves[square] & m_pieces[PieceType::All];
-    pieceMoves |= m_blackPawn2ForwardMoves[square] & m_pieces[PieceType::All] & (pieceMoves << 8);
-    pieceMoves |= m_blackPawnTakesMoves[square] & m_pieces[PieceType::White];
-    pieceMoves |= (m_blackPawnEnPassantMoves[square] & m_enPassantBitboard) * !inCheckAfterEnPassant(square, kingPosition);
-    return pieceMoves;
-}
+    //squares the pieces are allowed to move to
+    uint64_t targets = Type == MoveType::Captures ? m_pieces[PieceType::Black - us]
+        : Type == MoveType::Quiets ? m_pieces[PieceType::All]
+        : ~m_pieces[PieceType::White + us];
 
-uint64_t Board::getBlackPawnLegalMovesCapturesOnly(char square, char kingPosition) {
-    uint64_t pieceMoves = m_blackPawn1ForwardMoves[square] & m_pieces[PieceType::All];
-    pieceMoves |= m_blackPawn2ForwardMoves[square] & m_pieces[PieceType::All] & (pieceMoves << 8);
-    pieceMoves |= m_blackPawnTakesMoves[square] & m_pieces[PieceType::White];
-    pieceMoves |= (m_blackPawnEnPassantMoves[square] & m_enPassantBitboard) * !inCheckAfterEnPassant(square, kingPosition);
-    return pieceMoves & m_pieces[PieceType::Black - m_turn];
-}
+    moves->clear();
 
-uint64_t Board::getBlackPawnAttacks(char square) {
-    uint64_t pieceMoves = m_blackPawnTakesMoves[square];
+    //only the king can move out of a double check
+    uint64_t piecesBitboard = m_doubleCheck ? m_pieces[PieceType::WhiteKing + us] : m_pieces[PieceType::White + us];
+    while (piecesBitboard) {
+        char square = popLSB(&piecesBitboard);
+        addMoves<Us>(moves, square, getPieceLegalMoves<Us>(square, kingPosition, targets));
+    }
+}
+
+//extract a piece's moves into the move list
+template <Color Us>
+void Board::addMoves(MoveList* moves, char from, uint64_t pieceMoves) {
+    //pawns that are one square from the last rank promote with every move
+    bool promotion = (m_eightByEight[from] == PieceType::WhitePawn + static_cast<int>(Us))
+        && ((Us == Color::White) ? (from < 16) : (from > 47));
+    while (pieceMoves) {
+        char to = popLSB(&pieceMoves);
+        if (promotion) {
+            //add a move for promoting to each of a queen, knight, rook and bishop
+            moves->addMove(encodeMove(from, to, PieceType::WhiteQueen));
+            moves->addMove(encodeMove(from, to, PieceType::WhiteKnight));
+            moves->addMove(encodeMove(from, to, PieceType::WhiteRook));
+            moves->addMove(encodeMove(from, to, PieceType::WhiteBishop));
+        }
+        else {
+            moves->addMove(encodeMove(from, to, 0));
+        }
+    }
+}
+
+//calculate the legal moves of a single piece to a set of target squares
+//the attacking squares, check mask and pinned pieces must be up to date
+template <Color Us>
+uint64_t Board::getPieceLegalMoves(char square, char kingPosition, uint64_t targets) {
+    constexpr int us = static_cast<int>(Us);
+    uint64_t occupiedSquares = ~m_pieces[PieceType::All];
+
+    uint64_t pieceMoves = 0ull;
+    uint64_t checkMask = m_blockOrCaptureCheckMask;
+    switch (m_eightByEight[square]) {
+    case PieceType::WhiteRook + us:
+        pieceMoves = m_attackTables->getRookMoves(square, occupiedSquares);
+        break;
+    case PieceType::WhiteBishop + us:
+        pieceMoves = m_attackTables->getBishopMoves(square, occupiedSquares);
+        break;
+    case PieceType::WhiteQueen + us:
+        pieceMoves = m_attackTables->getRookMoves(square, occupiedSquares) | m_attackTables->getBishopMoves(square, occupiedSquares);
+        break;
+    case PieceType::WhiteKnight + us:
+        pieceMoves = lookupTables::KNIGHT_MOVES[square];
+        break;
+    case PieceType::WhitePawn + us:
+        pieceMoves = getPawnLegalMoves<Us>(square, kingPosition);
+        //pawns can also stop a check from a pawn that has just moved two squares by taking it en passant
+        checkMask |= m_enPassantBitboard * (m_check && (m_checkingPiece == m_enPassantSquare));
+        break;
+    case PieceType::WhiteKing + us:
+        //the king can't block a check, and can't move onto an attacked square, so the check mask doesn't apply
+        return getKingLegalMoves<Us>(square) & targets;
+    }
+
+    //restrict movement of pinned pieces
+    bool pinned = (1ull << square) & (m_pinnedPieces);
+    pieceMoves &= (lookupTables::getAlignMask(kingPosition, square) * pinned) + (~0ull * !pinned);
+
+    //restrict movement of pieces to enforce stopping the check
+    return pieceMoves & checkMask & targets;
+}
+
+template <Color Us>
+uint64_t Board::getPawnLegalMoves(char square, char kingPosition) {
+    uint64_t emptySquares = m_pieces[PieceType::All];
+    uint64_t pieceMoves;
+    if constexpr (Us == Color::White) {
+        pieceMoves = lookupTables::WHITE_PAWN_1_FORWARD_MOVES[square] & emptySquares;
+        pieceMoves |= lookupTables::WHITE_PAWN_2_FORWARD_MOVES[square] & emptySquares & (pieceMoves >> 8);
+        pieceMoves |= lookupTables::WHITE_PAWN_TAKES_MOVES[square] & m_pieces[PieceType::Black];
+        pieceMoves |= lookupTables::WHITE_PAWN_EN_PASSANT_MOVES[square] & m_enPassantBitboard;
+    }
+    else {
+        pieceMoves = lookupTables::BLACK_PAWN_1_FORWARD_MOVES[square] & emptySquares;
+        pieceMoves |= lookupTables::BLACK_PAWN_2_FORWARD_MOVES[square] & emptySquares & (pieceMoves << 8);
+        pieceMoves |= lookupTables::BLACK_PAWN_TAKES_MOVES[square] & m_pieces[PieceType::White];
+        pieceMoves |= lookupTables::BLACK_PAWN_EN_PASSANT_MOVES[square] & m_enPassantBitboard;
+    }
+    //an en passant capture takes two pieces off the rank, which could leave the king in check
+    if (pieceMoves & m_enPassantBitboard) {
+        pieceMoves &= ~(m_enPassantBitboard * inCheckAfterEnPassant<Us>(square, kingPosition));
+    }
     return pieceMoves;
 }
 
-uint64_t Board::getKnightLegalMoves(char square) {
-    return m_knightMoves[square] & (~m_pieces[PieceType::White + m_turn]);
-}
-
-uint64_t Board::getKnightLegalMovesCapturesOnly(char square) {
-    return m_knightMoves[square] & (~m_pieces[PieceType::White + m_turn]) & m_pieces[PieceType::Black - m_turn];
-}
-
-uint64_t Board::getKnightAttacks(char square) {
-    return m_knightMoves[square];
-}
-
+template <Color Us>
 uint64_t Board::getKingLegalMoves(char square) {
-    uint64_t pieceMoves = m_kingMoves[square] & (~m_pieces[PieceType::White + m_turn]);
-    bool whitesTurn = !m_turn;
-    pieceMoves |= (1ull << 58) * m_castleRights[0] * (((m_castlingEmptySquareBitboards[0] & m_pieces[PieceType::All]) == m_castlingEmptySquareBitboards[0]) && !(m_castlingAttackingSquareBitboards[0] & m_attackingSquares)) * whitesTurn;
-    pieceMoves |= (1ull << 62) * m_castleRights[1] * (((m_castlingEmptySquareBitboards[1] & m_pieces[PieceType::All]) == m_castlingEmptySquareBitboards[1]) && !(m_castlingAttackingSquareBitboards[1] & m_attackingSquares)) * whitesTurn;
-    pieceMoves |= (1ull << 2) * m_castleRights[2] * (((m_castlingEmptySquareBitboards[2] & m_pieces[PieceType::All]) == m_castlingEmptySquareBitboards[2]) && !(m_castlingAttackingSquareBitboards[2] & m_attackingSquares)) * m_turn;
-    pieceMoves |= (1ull << 6) * m_castleRights[3] * (((m_castlingEmptySquareBitboards[3] & m_pieces[PieceType::All]) == m_castlingEmptySquareBitboards[3]) && !(m_castlingAttackingSquareBitboards[3] & m_attackingSquares)) * m_turn;
+    constexpr int us = static_cast<int>(Us);
+    //the castles for this side, in the same order as the castle rights, and the squares the king moves to
+    constexpr int queensideCastle = 2 * us;
+    constexpr int kingsideCastle = 2 * us + 1;
+    constexpr uint64_t queensideTarget = Us == Color::White ? 1ull << 58 : 1ull << 2;
+    constexpr uint64_t kingsideTarget = Us == Color::White ? 1ull << 62 : 1ull << 6;
+
+    uint64_t pieceMoves = lookupTables::KING_MOVES[square] & (~m_pieces[PieceType::White + us]);
+    pieceMoves |= queensideTarget * m_castleRights[queensideCastle] * (((lookupTables::CASTLING_EMPTY_SQUARES[queensideCastle] & m_pieces[PieceType::All]) == lookupTables::CASTLING_EMPTY_SQUARES[queensideCastle]) && !(lookupTables::CASTLING_ATTACKING_SQUARES[queensideCastle] & m_attackingSquares));
+    pieceMoves |= kingsideTarget * m_castleRights[kingsideCastle] * (((lookupTables::CASTLING_EMPTY_SQUARES[kingsideCastle] & m_pieces[PieceType::All]) == lookupTables::CASTLING_EMPTY_SQUARES[kingsideCastle]) && !(lookupTables::CASTLING_ATTACKING_SQUARES[kingsideCastle] & m_attackingSquares));
     //remove moves which put the king into check
     pieceMoves &= ~m_attackingSquares;
     return pieceMoves;
 }
 
-uint64_t Board::getKingLegalMovesCapturesOnly(char square) {
-    uint64_t pieceMoves = m_kingMoves[square] & (~m_pieces[PieceType::White + m_turn]);
-    bool whitesTurn = !m_turn;
-    pieceMoves |= (1ull << 58) * m_castleRights[0] * (((m_castlingEmptySquareBitboards[0] & m_pieces[PieceType::All]) == m_castlingEmptySquareBitboards[0]) && !(m_castlingAttackingSquareBitboards[0] & m_attackingSquares)) * whitesTurn;
-    pieceMoves |= (1ull << 62) * m_castleRights[1] * (((m_castlingEmptySquareBitboards[1] & m_pieces[PieceType::All]) == m_castlingEmptySquareBitboards[1]) && !(m_castlingAttackingSquareBitboards[1] & m_attackingSquares)) * whitesTurn;
-    pieceMoves |= (1ull << 2) * m_castleRights[2] * (((m_castlingEmptySquareBitboards[2] & m_pieces[PieceType::All]) == m_castlingEmptySquareBitboards[2]) && !(m_castlingAttackingSquareBitboards[2] & m_attackingSquares)) * m_turn;
-    pieceMoves |= (1ull << 6) * m_castleRights[3] * (((m_castlingEmptySquareBitboards[3] & m_pieces[PieceType::All]) == m_castlingEmptySquareBitboards[3]) && !(m_castlingAttackingSquareBitboards[3] & m_attackingSquares)) * m_turn;
-    //remove moves which put the king into check
-    pieceMoves &= ~m_attackingSquares;
-    return pieceMoves & m_pieces[PieceType::Black - m_turn];
-}
-
-uint64_t Board::getKingAttacks(char square) {
-    return m_kingMoves[square];
-}
-
-void Board::getLegalMoves(unsigned char* numLegalMoves, unsigned char* legalMovesFrom, unsigned char* legalMovesTo, unsigned char* legalMovesFlags) {
-    updateAttackingSquares();
-    updatePinnedPieces();
-
-    char kingPosition = lsb(m_pieces[PieceType::WhiteKing + m_turn]);
-
-    *numLegalMoves = 0;
-
-    uint64_t pieceMoves;
-
-    if (m_doubleCheck) {
-        pieceMoves = getKingLegalMoves(kingPosition);
-
-        while (pieceMoves) {
-            legalMovesTo[*numLegalMoves] = popLSB(&pieceMoves);
-            legalMovesFrom[*numLegalMoves] = kingPosition;
-            legalMovesFlags[*numLegalMoves] = 0;
-
-            (*numLegalMoves)++;
-        }
-
-        return;
-    }
-
-    char pieces[16];
-    char numPieces = 0;
-    //unpack the bitboard of the white / black pieces and store them in an array
-    uint64_t piecesBitboard = m_pieces[PieceType::White + m_turn];
-    while (piecesBitboard) {
-        pieces[numPieces] = popLSB(&piecesBitboard);
-        numPieces++;
-    }
-
-    if (m_check) {
-        //calculate the line on which pieces have to block to stop the check
-        uint64_t blockOrCaptureCheckMask = m_alignMasks[kingPosition][m_checkingPiece] & m_alignMasks[m_checkingPiece][kingPosition];
-        //erase the line if the checking piece is not a sliding piece (check can't be blocked)
-        bool checkingPieceIsSliding = ((m_eightByEight[m_checkingPiece] == (PieceType::BlackQueen - m_turn))
-            || (m_eightByEight[m_checkingPiece] == (PieceType::BlackRook - m_turn))
-            || (m_eightByEight[m_checkingPiece] == (PieceType::BlackBishop - m_turn)));
-        blockOrCaptureCheckMask *= checkingPieceIsSliding;
-        //add the position of the checking piece, as it can be taken to stop check
-        blockOrCaptureCheckMask |= 1ull << m_checkingPiece;
-
-        for (char piece = 0; piece < numPieces; piece++) {
-            switch (m_eightByEight[pieces[piece]]) {
-            case PieceType::WhiteRook:
-                pieceMoves = getRookLegalMoves(pieces[piece]);
-                break;
-            case PieceType::BlackRook:
-                pieceMoves = getRookLegalMoves(pieces[piece]);
-                break;
-            case PieceType::WhiteBishop:
-                pieceMoves = getBishopLegalMoves(pieces[piece]);
-                break;
-            case PieceType::BlackBishop:
-                pieceMoves = getBishopLegalMoves(pieces[piece]);
-                break;
-            case PieceType::WhiteQueen:
-                pieceMoves = getQueenLegalMoves(pieces[piece]);
-                break;
-            case PieceType::BlackQueen:
-                pieceMoves = getQueenLegalMoves(pieces[piece]);
-                break;
-            case PieceType::WhitePawn:
-                pieceMoves = getWhitePawnLegalMoves(pieces[piece], kingPosition);
-                break;
-            case PieceType::BlackPawn:
-                pieceMoves = getBlackPawnLegalMoves(pieces[piece], kingPosition);
-                break;
-            case PieceType::WhiteKnight:
-                pieceMoves = getKnightLegalMoves(pieces[piece]);
-                break;
-            case PieceType::BlackKnight:
-                pieceMoves = getKnightLegalMoves(pieces[piece]);
-                break;
-            case PieceType::WhiteKing:
-                pieceMoves = getKingLegalMoves(pieces[piece]);
-                break;
-            case PieceType::BlackKing:
-                pieceMoves = getKingLegalMoves(pieces[piece]);
-                break;
-            }
-
-            //restrict movement of pinned pieces
-            bool pinned = (1ull << pieces[piece]) & (m_pinnedPieces);
-            pieceMoves &= (m_alignMasks[kingPosition][pieces[piece]] * pinned) + (~0ull * !pinned);
-
-            //restrict movement of pieces to enforce stopping the check
-            bool isKing = pieces[piece] == kingPosition;
-            pieceMoves &= (blockOrCaptureCheckMask * !isKing) + (~0ull * isKing);
-
-            //also restrict movement of the king to stop it moving along the line of check
-            //pieceMoves &= (~(m_alignMasks[m_checkingPiece][kingPosition] * isKing * checkingPieceIsSliding)) + (~0ull * !isKing);
-
-            //extract the piece's moves into the move arrays
-            while (pieceMoves) {
-                legalMovesTo[*numLegalMoves] = popLSB(&pieceMoves);
-                legalMovesFrom[*numLegalMoves] = pieces[piece];
-                //if promotion, add extra moves for promoting to a queen, rook, knight or bishop
-                if (((m_eightByEight[legalMovesFrom[*numLegalMoves]] == PieceType::WhitePawn) && (legalMovesTo[*numLegalMoves] < 8))
-                    || ((m_eightByEight[legalMovesFrom[*numLegalMoves]] == PieceType::BlackPawn) && (legalMovesTo[*numLegalMoves] > 55))) {
-                    legalMovesFlags[*numLegalMoves] = PieceType::WhiteQueen;
-                    legalMovesFrom[*numLegalMoves + 1] = legalMovesFrom[*numLegalMoves];
-                    legalMovesTo[*numLegalMoves + 1] = legalMovesTo[*numLegalMoves];
-                    legalMovesFlags[*numLegalMoves + 1] = PieceType::WhiteKnight;
-                    legalMovesFrom[*numLegalMoves + 2] = legalMovesFrom[*numLegalMoves];
-                    legalMovesTo[*numLegalMoves + 2] = legalMovesTo[*numLegalMoves];
-                    legalMovesFlags[*numLegalMoves + 2] = PieceType::WhiteRook;
-                    legalMovesFrom[*numLegalMoves + 3] = legalMovesFrom[*numLegalMoves];
-                    legalMovesTo[*numLegalMoves + 3] = legalMovesTo[*numLegalMoves];
-                    legalMovesFlags[*numLegalMoves + 3] = PieceType::WhiteBishop;
-
-                    (*numLegalMoves) += 4;
-                }
-                else {
-                    legalMovesFlags[*numLegalMoves] = 0;
-                    (*numLegalMoves)++;
-                }
-            }
-        }
-
-        return;
-    }
-
-    for (char piece = 0; piece < numPieces; piece++) {
-        switch (m_eightByEight[pieces[piece]]) {
-        case PieceType::WhiteRook:
-            pieceMoves = getRookLegalMoves(pieces[piece]);
-            break;
-        case PieceType::BlackRook:
-            pieceMoves = getRookLegalMoves(pieces[piece]);
-            break;
-        case PieceType::WhiteBishop:
-            pieceMoves = getBishopLegalMoves(pieces[piece]);
-            break;
-        case PieceType::BlackBishop:
-            pieceMoves = getBishopLegalMoves(pieces[piece]);
-            break;
-        case PieceType::WhiteQueen:
-            pieceMoves = getQueenLegalMoves(pieces[piece]);
-            break;
-        case PieceType::BlackQueen:
-            pieceMoves = getQueenLegalMoves(pieces[piece]);
-            break;
-        case PieceType::WhitePawn:
-            pieceMoves = getWhitePawnLegalMoves(pieces[piece], kingPosition);
-            break;
-        case PieceType::BlackPawn:
-            pieceMoves = getBlackPawnLegalMoves(pieces[piece], kingPosition);
-            break;
-        case PieceType::WhiteKnight:
-            pieceMoves = getKnightLegalMoves(pieces[piece]);
-            break;
-        case PieceType::BlackKnight:
-            pieceMoves = getKnightLegalMoves(pieces[piece]);
-            break;
-        case PieceType::WhiteKing:
-            pieceMoves = getKingLegalMoves(pieces[piece]);
-            break;
-        case PieceType::BlackKing:
-            pieceMoves = getKingLegalMoves(pieces[piece]);
-            break;
-        }
-
-        //restrict movement of pinned pieces
-        bool pinned = (1ull << pieces[piece]) & (m_pinnedPieces);
-        pieceMoves &= (m_alignMasks[kingPosition][pieces[piece]] * pinned) + (~0ull * !pinned);
-
-        //extract the piece's moves into the move arrays
-        while (pieceMoves) {
-            legalMovesTo[*numLegalMoves] = popLSB(&pieceMoves);
-            legalMovesFrom[*numLegalMoves] = pieces[piece];
-            //if promotion, add extra moves for promoting to a queen, rook, knight or bishop
-            if (((m_eightByEight[legalMovesFrom[*numLegalMoves]] == PieceType::WhitePawn) && (legalMovesTo[*numLegalMoves] < 8))
-                || ((m_eightByEight[legalMovesFrom[*numLegalMoves]] == PieceType::BlackPawn) && (legalMovesTo[*numLegalMoves] > 55))) {
-                legalMovesFlags[*numLegalMoves] = PieceType::WhiteQueen;
-                legalMovesFrom[*numLegalMoves + 1] = legalMovesFrom[*numLegalMoves];
-                legalMovesTo[*numLegalMoves + 1] = legalMovesTo[*numLegalMoves];
-                legalMovesFlags[*numLegalMoves + 1] = PieceType::WhiteKnight;
-                legalMovesFrom[*numLegalMoves + 2] = legalMovesFrom[*numLegalMoves];
-                legalMovesTo[*numLegalMoves + 2] = legalMovesTo[*numLegalMoves];
-                legalMovesFlags[*numLegalMoves + 2] = PieceType::WhiteRook;
-                legalMovesFrom[*numLegalMoves + 3] = legalMovesFrom[*numLegalMoves];
-                legalMovesTo[*numLegalMoves + 3] = legalMovesTo[*numLegalMoves];
-                legalMovesFlags[*numLegalMoves + 3] = PieceType::WhiteBishop;
-
-                (*numLegalMoves) += 4;
-            }
-            else {
-                legalMovesFlags[*numLegalMoves] = 0;
-                (*numLegalMoves)++;
-            }
-        }
+//check whether a move (e.g. from the transposition table) is legal without generating all of the legal moves
+//this uses the attacking squares and pinned pieces from prepareMoveGeneration()
+bool Board::isMoveLegal(Move move) {
+    if (m_turn) {
+        return isMoveLegal<Color::Black>(move);
     }
+    return isMoveLegal<Color::White>(move);
 }
 
-void Board::getCaptureMoves(unsigned char* numLegalMoves, unsigned char* legalMovesFrom, unsigned char* legalMovesTo, unsigned char* legalMovesFlags) {
-    updateAttackingSquares();
-    updatePinnedPieces();
-
-    char kingPosition = lsb(m_pieces[PieceType::WhiteKing + m_turn]);
-
-    *numLegalMoves = 0;
-
-    uint64_t pieceMoves;
-
-    if (m_doubleCheck) {
-        pieceMoves = getKingLegalMovesCapturesOnly(kingPosition);
+template <Color Us>
+bool Board::isMoveLegal(Move move) {
+    constexpr int us = static_cast<int>(Us);
 
-        while (pieceMoves) {
-            legalMovesTo[*numLegalMoves] = popLSB(&pieceMoves);
-            legalMovesFrom[*numLegalMoves] = kingPosition;
-            legalMovesFlags[*numLegalMoves] = 0;
+    unsigned char from = getMoveFrom(move);
+    unsigned char to = getMoveTo(move);
+    unsigned char flags = getMoveFlags(move);
 
-            (*numLegalMoves)++;
-        }
-
-        return;
+    //the piece being moved must belong to the side to move
+    char piece = m_eightByEight[from];
+    if ((piece > 11) || (constants::PIECE_SIDES[piece] != us)) {
+        return false;
     }
 
-    char pieces[16];
-    char numPieces = 0;
-    //unpack the bitboard of the white / black pieces and store them in an array
-    uint64_t piecesBitboard = m_pieces[PieceType::White + m_turn];
-    while (piecesBitboard) {
-        pieces[numPieces] = popLSB(&piecesBitboard);
-        numPieces++;
+    //pawns moving to the last rank must promote to a queen, bishop, knight or rook, and nothing else can promote
+    bool promotion = (piece == PieceType::WhitePawn + us) && ((Us == Color::White) ? (to < 8) : (to > 55));
+    bool validPromotionFlags = (flags == PieceType::WhiteQueen) || (flags == PieceType::WhiteBishop)
+        || (flags == PieceType::WhiteKnight) || (flags == PieceType::WhiteRook);
+    if (promotion ? !validPromotionFlags : (flags != 0)) {
+        return false;
     }
 
-    if (m_check) {
-        //calculate the line on which pieces have to block to stop the check
-        uint64_t blockOrCaptureCheckMask = m_alignMasks[kingPosition][m_checkingPiece] & m_alignMasks[m_checkingPiece][kingPosition];
-        //erase the line if the checking piece is not a sliding piece (check can't be blocked)
-        bool checkingPieceIsSliding = ((m_eightByEight[m_checkingPiece] == (PieceType::BlackQueen - m_turn))
-            || (m_eightByEight[m_checkingPiece] == (PieceType::BlackRook - m_turn))
-            || (m_eightByEight[m_checkingPiece] == (PieceType::BlackBishop - m_turn)));
-        blockOrCaptureCheckMask *= checkingPieceIsSliding;
-        //add the position of the checking piece, as it can be taken to stop check
-        blockOrCaptureCheckMask |= 1ull << m_checkingPiece;
-
-        for (char piece = 0; piece < numPieces; piece++) {
-            switch (m_eightByEight[pieces[piece]]) {
-            case PieceType::WhiteRook:
-                pieceMoves = getRookLegalMovesCapturesOnly(pieces[piece]);
-                break;
-            case PieceType::BlackRook:
-                pieceMoves = getRookLegalMovesCapturesOnly(pieces[piece]);
-                break;
-            case PieceType::WhiteBishop:
-                pieceMoves = getBishopLegalMovesCapturesOnly(pieces[piece]);
-                break;
-            case PieceType::BlackBishop:
-                pieceMoves = getBishopLegalMovesCapturesOnly(pieces[piece]);
-                break;
-            case PieceType::WhiteQueen:
-                pieceMoves = getQueenLegalMovesCapturesOnly(pieces[piece]);
-                break;
-            case PieceType::BlackQueen:
-                pieceMoves = getQueenLegalMovesCapturesOnly(pieces[piece]);
-                break;
-            case PieceType::WhitePawn:
-                pieceMoves = getWhitePawnLegalMovesCapturesOnly(pieces[piece], kingPosition);
-                break;
-            case PieceType::BlackPawn:
-                pieceMoves = getBlackPawnLegalMovesCapturesOnly(pieces[piece], kingPosition);
-                break;
-            case PieceType::WhiteKnight:
-                pieceMoves = getKnightLegalMovesCapturesOnly(pieces[piece]);
-                break;
-            case PieceType::BlackKnight:
-                pieceMoves = getKnightLegalMovesCapturesOnly(pieces[piece]);
-                break;
-            case PieceType::WhiteKing:
-                pieceMoves = getKingLegalMovesCapturesOnly(pieces[piece]);
-                break;
-            case PieceType::BlackKing:
-                pieceMoves = getKingLegalMovesCapturesOnly(pieces[piece]);
-                break;
-            }
-
-            //restrict movement of pinned pieces
-            bool pinned = (1ull << pieces[piece]) & (m_pinnedPieces);
-            pieceMoves &= (m_alignMasks[kingPosition][pieces[piece]] * pinned) + (~0ull * !pinned);
-
-            //restrict movement of pieces to enforce stopping the check
-            bool isKing = pieces[piece] == kingPosition;
-            pieceMoves &= (blockOrCaptureCheckMask * !isKing) + (~0ull * isKing);
-
-            //also restrict movement of the king to stop it moving along the line of check
-            //pieceMoves &= (~(m_alignMasks[m_checkingPiece][kingPosition] * isKing * checkingPieceIsSliding)) + (~0ull * !isKing);
-
-            //extract the piece's moves into the move arrays
-            while (pieceMoves) {
-                legalMovesTo[*numLegalMoves] = popLSB(&pieceMoves);
-                legalMovesFrom[*numLegalMoves] = pieces[piece];
-                //if promotion, add extra moves for promoting to a queen, rook, knight or bishop
-                if (((m_eightByEight[legalMovesFrom[*numLegalMoves]] == PieceType::WhitePawn) && (legalMovesTo[*numLegalMoves] < 8))
-                    || ((m_eightByEight[legalMovesFrom[*numLegalMoves]] == PieceType::BlackPawn) && (legalMovesTo[*numLegalMoves] > 55))) {
-                    legalMovesFlags[*numLegalMoves] = PieceType::WhiteQueen;
-                    legalMovesFrom[*numLegalMoves + 1] = legalMovesFrom[*numLegalMoves];
-                    legalMovesTo[*numLegalMoves + 1] = legalMovesTo[*numLegalMoves];
-                    legalMovesFlags[*numLegalMoves + 1] = PieceType::WhiteKnight;
-                    legalMovesFrom[*numLegalMoves + 2] = legalMovesFrom[*numLegalMoves];
-                    legalMovesTo[*numLegalMoves + 2] = legalMovesTo[*numLegalMoves];
-                    legalMovesFlags[*numLegalMoves + 2] = PieceType::WhiteRook;
-                    legalMovesFrom[*numLegalMoves + 3] = legalMovesFrom[*numLegalMoves];
-                    legalMovesTo[*numLegalMoves + 3] = legalMovesTo[*numLegalMoves];
-                    legalMovesFlags[*numLegalMoves + 3] = PieceType::WhiteBishop;
-
-                    (*numLegalMoves) += 4;
-                }
-                else {
-                    legalMovesFlags[*numLegalMoves] = 0;
-                    (*numLegalMoves)++;
-                }
-            }
-        }
-
-        return;
+    //only the king can move out of a double check
+    if (m_doubleCheck && (piece != PieceType::WhiteKing + us)) {
+        return false;
     }
 
-    for (char piece = 0; piece < numPieces; piece++) {
-        switch (m_eightByEight[pieces[piece]]) {
-        case PieceType::WhiteRook:
-            pieceMoves = getRookLegalMovesCapturesOnly(pieces[piece]);
-            break;
-        case PieceType::BlackRook:
-            pieceMoves = getRookLegalMovesCapturesOnly(pieces[piece]);
-            break;
-        case PieceType::WhiteBishop:
-            pieceMoves = getBishopLegalMovesCapturesOnly(pieces[piece]);
-            break;
-        case PieceType::BlackBishop:
-            pieceMoves = getBishopLegalMovesCapturesOnly(pieces[piece]);
-            break;
-        case PieceType::WhiteQueen:
-            pieceMoves = getQueenLegalMovesCapturesOnly(pieces[piece]);
-            break;
-        case PieceType::BlackQueen:
-            pieceMoves = getQueenLegalMovesCapturesOnly(pieces[piece]);
-            break;
-        case PieceType::WhitePawn:
-            pieceMoves = getWhitePawnLegalMovesCapturesOnly(pieces[piece], kingPosition);
-            break;
-        case PieceType::BlackPawn:
-            pieceMoves = getBlackPawnLegalMovesCapturesOnly(pieces[piece], kingPosition);
-            break;
-        case PieceType::WhiteKnight:
-            pieceMoves = getKnightLegalMovesCapturesOnly(pieces[piece]);
-            break;
-        case PieceType::BlackKnight:
-            pieceMoves = getKnightLegalMovesCapturesOnly(pieces[piece]);
-            break;
-        case PieceType::WhiteKing:
-            pieceMoves = getKingLegalMovesCapturesOnly(pieces[piece]);
-            break;
-        case PieceType::BlackKing:
-            pieceMoves = getKingLegalMovesCapturesOnly(pieces[piece]);
-            break;
-        }
-
-        //restrict movement of pinned pieces
-        bool pinned = (1ull << pieces[piece]) & (m_pinnedPieces);
-        pieceMoves &= (m_alignMasks[kingPosition][pieces[piece]] * pinned) + (~0ull * !pinned);
-
-        //extract the piece's moves into the move arrays
-        while (pieceMoves) {
-            legalMovesTo[*numLegalMoves] = popLSB(&pieceMoves);
-            legalMovesFrom[*numLegalMoves] = pieces[piece];
-            //if promotion, add extra moves for promoting to a queen, rook, knight or bishop
-            if (((m_eightByEight[legalMovesFrom[*numLegalMoves]] == PieceType::WhitePawn) && (legalMovesTo[*numLegalMoves] < 8))
-                || ((m_eightByEight[legalMovesFrom[*numLegalMoves]] == PieceType::BlackPawn) && (legalMovesTo[*numLegalMoves] > 55))) {
-                legalMovesFlags[*numLegalMoves] = PieceType::WhiteQueen;
-                legalMovesFrom[*numLegalMoves + 1] = legalMovesFrom[*numLegalMoves];
-                legalMovesTo[*numLegalMoves + 1] = legalMovesTo[*numLegalMoves];
-                legalMovesFlags[*numLegalMoves + 1] = PieceType::WhiteKnight;
-                legalMovesFrom[*numLegalMoves + 2] = legalMovesFrom[*numLegalMoves];
-                legalMovesTo[*numLegalMoves + 2] = legalMovesTo[*numLegalMoves];
-                legalMovesFlags[*numLegalMoves + 2] = PieceType::WhiteRook;
-                legalMovesFrom[*numLegalMoves + 3] = legalMovesFrom[*numLegalMoves];
-                legalMovesTo[*numLegalMoves + 3] = legalMovesTo[*numLegalMoves];
-                legalMovesFlags[*numLegalMoves + 3] = PieceType::WhiteBishop;
-
-                (*numLegalMoves) += 4;
-            }
-            else {
-                legalMovesFlags[*numLegalMoves] = 0;
-                (*numLegalMoves)++;
-            }
-        }
-    }
+    char kingPosition = lsb(m_pieces[PieceType::WhiteKing + us]);
+    return (getPieceLegalMoves<Us>(from, kingPosition, ~m_pieces[PieceType::White + us]) >> to) & 1ull;
 }
 
-uint64_t Board::getLegalMovesBitboardForSquare(char square, unsigned char* numLegalMoves, unsigned char* legalMovesFrom, unsigned char* legalMovesTo) {
+uint64_t Board::getLegalMovesBitboardForSquare(char square, MoveList* moves) {
     uint64_t movesBitboard = 0ull;
-    for (unsigned char move = 0; move < *numLegalMoves; move++) {
-        if (legalMovesFrom[move] == square) {
-            movesBitboard |= 1ull << legalMovesTo[move];
+    for (int move = 0; move < moves->size(); move++) {
+        if (getMoveFrom(moves->getMove(move)) == square) {
+            movesBitboard |= 1ull << getMoveTo(moves->getMove(move));
         }
     }
 
     return movesBitboard;
 }
 
+template <Color Us>
 void Board::updateAttackingSquares() {
-    m_check = m_doubleCheck = false;
-
-    char pieces[16];
-    char numPieces = 0;
-    //unpack the bitboard of the white / black pieces and store them in an array
-    uint64_t piecesBitboard = m_pieces[PieceType::Black - m_turn];
-    while (piecesBitboard) {
-        pieces[numPieces] = popLSB(&piecesBitboard);
-        numPieces++;
-    }
+    constexpr int us = static_cast<int>(Us);
+    char kingPosition = lsb(m_pieces[PieceType::WhiteKing + us]);
+    //the king is taken off the board, so that it can't move backwards along the line of a check
+    uint64_t occupiedSquares = (~m_pieces[PieceType::All]) ^ m_pieces[PieceType::WhiteKing + us];
 
     m_attackingSquares = 0ull;
-
-    uint64_t pieceAttacks;
-
-    bool isPieceCheckingKing;
-    m_checkingPiece = 0;
-
-    for (char piece = 0; piece < numPieces; piece++) {
-        switch (m_eightByEight[pieces[piece]]) {
-        case PieceType::WhiteRook:
-            pieceAttacks = getRookAttacks(pieces[piece]);
-            m_attackingSquares |= pieceAttacks;
-            break;
-        case PieceType::BlackRook:
-            pieceAttacks = getRookAttacks(pieces[piece]);
-            m_attackingSquares |= pieceAttacks;
-            break;
-        case PieceType::WhiteBishop:
-            pieceAttacks = getBishopAttacks(pieces[piece]);
-            m_attackingSquares |= pieceAttacks;
-            break;
-        case PieceType::BlackBishop:
-            pieceAttacks = getBishopAttacks(pieces[piece]);
-            m_attackingSquares |= pieceAttacks;
-            break;
-        case PieceType::WhiteQueen:
-            pieceAttacks = getQueenAttacks(pieces[piece]);
-            m_attackingSquares |= pieceAttacks;
-            break;
-        case PieceType::BlackQueen:
-            pieceAttacks = getQueenAttacks(pieces[piece]);
-            m_attackingSquares |= pieceAttacks;
-            break;
-        case PieceType::WhitePawn:
-            pieceAttacks = getWhitePawnAttacks(pieces[piece]);
-            m_attackingSquares |= pieceAttacks;
-            m_pawnAttackingSquares = pieceAttacks;
-            break;
-        case PieceType::BlackPawn:
-            pieceAttacks = getBlackPawnAttacks(pieces[piece]);
-            m_attackingSquares |= pieceAttacks;
-            m_pawnAttackingSquares = pieceAttacks;
-            break;
-        case PieceType::WhiteKnight:
-            pieceAttacks = getKnightAttacks(pieces[piece]);
-            m_attackingSquares |= pieceAttacks;
-            break;
-        case PieceType::BlackKnight:
-            pieceAttacks = getKnightAttacks(pieces[piece]);
-            m_attackingSquares |= pieceAttacks;
-            break;
-        case PieceType::WhiteKing:
-            pieceAttacks = getKingAttacks(pieces[piece]);
-            m_attackingSquares |= pieceAttacks;
-            break;
-        case PieceType::BlackKing:
-            pieceAttacks = getKingAttacks(pieces[piece]);
-            m_attackingSquares |= pieceAttacks;
-            break;
-        }
-
-        isPieceCheckingKing = pieceAttacks & m_pieces[PieceType::WhiteKing + m_turn];
-        m_doubleCheck = m_doubleCheck || (m_check && isPieceCheckingKing);
-        m_check = m_check || isPieceCheckingKing;
-        m_checkingPiece += pieces[piece] * isPieceCheckingKing;
-    }
-}
-
-bool Board::isMovePromotion(unsigned char from, unsigned char to, unsigned char* numLegalMoves, unsigned char* legalMovesFrom, unsigned char* legalMovesTo, unsigned char* legalMovesFlags) {
-    for (unsigned char move = 0; move < *numLegalMoves; move++) {
-        if ((legalMovesFrom[move] == from) && (legalMovesTo[move] == to) && legalMovesFlags[move]) {
+    for (char pieceType = PieceType::BlackKing - us; pieceType < 12; pieceType += 2) {
+        m_pieceTypeAttacks[pieceType] = calculatePieceTypeAttacks(pieceType, occupiedSquares);
+        m_attackingSquares |= m_pieceTypeAttacks[pieceType];
+    }
+
+    //look outwards from the king for enemy pieces that attack it
+    uint64_t enemyRooks = m_pieces[PieceType::BlackRook - us] | m_pieces[PieceType::BlackQueen - us];
+    uint64_t enemyBishops = m_pieces[PieceType::BlackBishop - us] | m_pieces[PieceType::BlackQueen - us];
+    m_checkers = (getPawnAttacks(m_pieces[PieceType::WhiteKing + us], us) & m_pieces[PieceType::BlackPawn - us])
+        | (lookupTables::KNIGHT_MOVES[kingPosition] & m_pieces[PieceType::BlackKnight - us])
+        | (m_attackTables->getRookMoves(kingPosition, occupiedSquares) & enemyRooks)
+        | (m_attackTables->getBishopMoves(kingPosition, occupiedSquares) & enemyBishops);
+    m_check = m_checkers;
+    m_doubleCheck = m_checkers & (m_checkers - 1);
+    m_checkingPiece = m_check ? lsb(m_checkers) : 0;
+
+    //the squares that pieces other than the king have to move to to stop a check, which is the checking piece and the
+    //squares between it and the king if it can be blocked
+    m_blockOrCaptureCheckMask = ~0ull;
+    if (m_check) {
+        uint64_t checkingPiece = 1ull << m_checkingPiece;
+        bool checkingPieceIsSliding = checkingPiece & (enemyRooks | enemyBishops);
+        m_blockOrCaptureCheckMask = checkingPiece | ((lookupTables::getAlignMask(kingPosition, m_checkingPiece)
+            & lookupTables::getAlignMask(m_checkingPiece, kingPosition)) * checkingPieceIsSliding);
+    }
+}
+
+uint64_t Board::calculatePieceTypeAttacks(char pieceType, uint64_t occupiedSquares) {
+    uint64_t pieces = m_pieces[pieceType];
+    uint64_t attacks = 0ull;
+    switch (pieceType) {
+    case PieceType::WhitePawn:
+    case PieceType::BlackPawn:
+        return getPawnAttacks(pieces, pieceType == PieceType::BlackPawn);
+    case PieceType::WhiteKnight:
+    case PieceType::BlackKnight:
+        while (pieces) {
+            attacks |= lookupTables::KNIGHT_MOVES[popLSB(&pieces)];
+        }
+        return attacks;
+    case PieceType::WhiteKing:
+    case PieceType::BlackKing:
+        return pieces ? lookupTables::KING_MOVES[lsb(pieces)] : 0ull;
+    case PieceType::WhiteRook:
+    case PieceType::BlackRook:
+        while (pieces) {
+            attacks |= m_attackTables->getRookMoves(popLSB(&pieces), occupiedSquares);
+        }
+        return attacks;
+    case PieceType::WhiteBishop:
+    case PieceType::BlackBishop:
+        while (pieces) {
+            attacks |= m_attackTables->getBishopMoves(popLSB(&pieces), occupiedSquares);
+        }
+        return attacks;
+    case PieceType::WhiteQueen:
+    case PieceType::BlackQueen:
+        while (pieces) {
+            char square = popLSB(&pieces);
+            attacks |= m_attackTables->getRookMoves(square, occupiedSquares) | m_attackTables->getBishopMoves(square, occupiedSquares);
+        }
+        return attacks;
+    }
+    return attacks;
+}
+
+bool Board::isMovePromotion(unsigned char from, unsigned char to, MoveList* moves) {
+    for (int move = 0; move < moves->size(); move++) {
+        if ((getMoveFrom(moves->getMove(move)) == from) && (getMoveTo(moves->getMove(move)) == to) && getMoveFlags(moves->getMove(move))) {
             return true;
         }
     }
     return false;
 }
 
+template <Color Us>
 void Board::updatePinnedPieces() {
-    char kingPos = lsb(m_pieces[PieceType::WhiteKing + m_turn]);
-    char distanceFromTop = kingPos / 8;
-    char distanceFromLeft = kingPos % 8;
-    char distancesFromEdge[8];
-    distancesFromEdge[0] = 7 - distanceFromLeft;
-    distancesFromEdge[1] = 7 - distanceFromTop;
-    distancesFromEdge[2] = distanceFromLeft;
-    distancesFromEdge[3] = distanceFromTop;
-    distancesFromEdge[4] = min(distancesFromEdge[0], distancesFromEdge[1]);
-    distancesFromEdge[5] = min(distancesFromEdge[1], distancesFromEdge[2]);
-    distancesFromEdge[6] = min(distancesFromEdge[2], distancesFromEdge[3]);
-    distancesFromEdge[7] = min(distancesFromEdge[3], distancesFromEdge[0]);
-
+    constexpr int us = static_cast<int>(Us);
+    char kingPosition = lsb(m_pieces[PieceType::WhiteKing + us]);
+    uint64_t friendlyPieces = m_pieces[PieceType::White + us];
+    uint64_t enemyPieces = m_pieces[PieceType::Black - us];
+
+    //enemy sliding pieces that would attack the king if none of the friendly pieces were on the board
+    uint64_t pinners = (m_attackTables->getRookMoves(kingPosition, enemyPieces)
+        & (m_pieces[PieceType::BlackRook - us] | m_pieces[PieceType::BlackQueen - us]))
+        | (m_attackTables->getBishopMoves(kingPosition, enemyPieces)
+        & (m_pieces[PieceType::BlackBishop - us] | m_pieces[PieceType::BlackQueen - us]));
+
+    //a friendly piece is pinned if it is the only piece between the king and one of them
     m_pinnedPieces = 0ull;
-    for (char direction = 0; direction < 8; direction++) {
-        uint64_t friendlyPieceAlongRay = 0ull;
-        char position = kingPos;
-        for (int i = 0; i < distancesFromEdge[direction]; i++) {
-            position += constants::DIRECTION_OFFSETS[direction];
-            if (m_eightByEight[position] < 12) {
-                if (constants::PIECE_SIDES[m_eightByEight[position]] == m_turn) {
-                    if (friendlyPieceAlongRay) {
-                        //this is the second friendly piece in a row along the ray, so there's no pin
-                        break;
-                    }
-                    else {
-                        friendlyPieceAlongRay = 1ull << position;
-                    }
-                }
-                else {
-                    //calculate if the piece is able to attack in the direction of the king
-                    bool xRayingKing = (m_eightByEight[position] == (PieceType::BlackQueen - m_turn))
-                        || ((direction < 4) && (m_eightByEight[position] == (PieceType::BlackRook - m_turn)))
-                        || ((direction > 3) && (m_eightByEight[position] == (PieceType::BlackBishop - m_turn)));
-                    m_pinnedPieces |= friendlyPieceAlongRay * xRayingKing;
-                    break;
-                }
-            }
-        }
+    while (pinners) {
+        char pinner = popLSB(&pinners);
+        uint64_t between = lookupTables::getAlignMask(kingPosition, pinner) & lookupTables::getAlignMask(pinner, kingPosition) & friendlyPieces;
+        m_pinnedPieces |= between * !(between & (between - 1));
     }
 }
 
-//calculate the bitboards on whitch pinned pieces can move along
-void Board::calculateAlignMasks() {
-    for (char kingSquare = 0; kingSquare < 64; kingSquare++) {
-        m_alignMasks[kingSquare] = new uint64_t[64];
-
-        char distanceFromTop = kingSquare / 8;
-        char distanceFromLeft = kingSquare % 8;
-        char distancesFromEdge[8];
-        distancesFromEdge[0] = 7 - distanceFromLeft;
-        distancesFromEdge[1] = 7 - distanceFromTop;
-        distancesFromEdge[2] = distanceFromLeft;
-        distancesFromEdge[3] = distanceFromTop;
-        distancesFromEdge[4] = min(distancesFromEdge[0], distancesFromEdge[1]);
-        distancesFromEdge[5] = min(distancesFromEdge[1], distancesFromEdge[2]);
-        distancesFromEdge[6] = min(distancesFromEdge[2], distancesFromEdge[3]);
-        distancesFromEdge[7] = min(distancesFromEdge[3], distancesFromEdge[0]);
-
-        for (char direction = 0; direction < 8; direction++) {
-            uint64_t alignmentMask = 0ull;
-
-            char position = kingSquare;
-            for (int i = 0; i < distancesFromEdge[direction]; i++) {
-                position += constants::DIRECTION_OFFSETS[direction];
-                alignmentMask |= 1ull << position;
-            }
+unsigned long long Board::perft(int depth, PerftHashTable* hashTable) {
+    if (depth == 0) {
+        return 1;
+    }
 
-            uint64_t piecesWithMask = alignmentMask;
-            while (piecesWithMask) {
-                m_alignMasks[kingSquare][popLSB(&piecesWithMask)] = alignmentMask;
-            }
-        }
+    unsigned long long numPositions;
+    if (hashTable && (depth > 1) && hashTable->probe(m_zobristKeys[m_ply], depth, &numPositions)) {
+        return numPositions;
     }
-}
 
-void Board::getUnMakeMoveState(unMakeMoveState* prevMoveState, char to) {
-    prevMoveState->takenPieceType = m_eightByEight[to];
-    prevMoveState->enPassantSquare = m_enPassantSquare;
-    prevMoveState->enPassantBitboard = m_enPassantBitboard;
-    prevMoveState->lastTakeOrPawnMove = m_lastTakeOrPawnMove;
-    prevMoveState->last50MoveRule = m_50MoveRule;
-    prevMoveState->castleRights[0] = m_castleRights[0];
-    prevMoveState->castleRights[1] = m_castleRights[1];
-    prevMoveState->castleRights[2] = m_castleRights[2];
-    prevMoveState->castleRights[3] = m_castleRights[3];
-}
+    MoveList moves;
+    getLegalMoves(&moves);
 
-unsigned long long Board::perft(int depth) {
+    //the moves are all legal, so there is no need to make them to count the positions at the last depth
     if (depth == 1) {
-        unsigned char numLegalMoves;
-        unsigned char legalMovesFrom[256];
-        unsigned char legalMovesTo[256];
-        unsigned char legalMovesFlags[256];
-        getLegalMoves(&numLegalMoves, legalMovesFrom, legalMovesTo, legalMovesFlags);
-        return numLegalMoves;
+        return moves.size();
     }
-    else {
-        unsigned long long numPositions = 0;
-
-        unsigned char numLegalMoves;
-        unsigned char legalMovesFrom[256];
-        unsigned char legalMovesTo[256];
-        unsigned char legalMovesFlags[256];
-
-        getLegalMoves(&numLegalMoves, legalMovesFrom, legalMovesTo, legalMovesFlags);
 
-        for (int moveNum = 0; moveNum < numLegalMoves; moveNum++) {
-            unMakeMoveState prevMoveState;
-            getUnMakeMoveState(&prevMoveState, legalMovesTo[moveNum]);
-            makeMove(legalMovesFrom[moveNum], legalMovesTo[moveNum], legalMovesFlags[moveNum]);
-            numPositions += perft(depth - 1);
-            unMakeMove(legalMovesFrom[moveNum], legalMovesTo[moveNum], legalMovesFlags[moveNum], &prevMoveState);
-        }
+    numPositions = 0;
+    for (int moveNum = 0; moveNum < moves.size(); moveNum++) {
+        makeMove(moves.getMove(moveNum));
+        numPositions += perft(depth - 1, hashTable);
+        unMakeMove(moves.getMove(moveNum));
+    }
 
-        return numPositions;
+    if (hashTable) {
+        hashTable->record(m_zobristKeys[m_ply], depth, numPositions);
     }
+    return numPositions;
 }
 
+template <Color Us>
 bool Board::inCheckAfterEnPassant(char friendlyPawnSquare, char kingPosition) {
-    if (m_enPassantSquare < 64) {
-        if ((kingPosition / 8) != (m_enPassantSquare / 8)) {
-            return false;
-        }
-        uint64_t blockerBitboard = (~m_pieces[PieceType::All]);
-        blockerBitboard ^= (1ull << m_enPassantSquare) | (1ull << friendlyPawnSquare);
-        blockerBitboard &= m_rookMovementMasks[kingPosition];
-        uint64_t key = (blockerBitboard * constants::ROOK_MAGICS[kingPosition]) >> constants::ROOK_SHIFTS[kingPosition];
-        uint64_t kingRays = m_rookMovesLookup[kingPosition][key] & (~m_pieces[PieceType::White + m_turn]);
-        return kingRays & (m_pieces[PieceType::BlackRook - m_turn] | m_pieces[PieceType::BlackQueen - m_turn]);
+    constexpr int us = static_cast<int>(Us);
+    if ((kingPosition / 8) != (m_enPassantSquare / 8)) {
+        return false;
     }
-
-    return false;
+    uint64_t blockerBitboard = (~m_pieces[PieceType::All]);
+    blockerBitboard ^= (1ull << m_enPassantSquare) | (1ull << friendlyPawnSquare);
+    uint64_t kingRays = m_attackTables->getRookMoves(kingPosition, blockerBitboard) & (~m_pieces[PieceType::White + us]);
+    return kingRays & (m_pieces[PieceType::BlackRook - us] | m_pieces[PieceType::BlackQueen - us]);
 }
 
 string Board::getSquareName(char squareNum) {
@@ -1603,9 +760,10 @@ string Board::getSquareName(char squareNum) {
     return value;
 }
 
-string Board::getMoveName(char from, char to, char flags) {
-    string result = getSquareName(from);
-    result.append(getSquareName(to));
+string Board::getMoveName(Move move) {
+    char flags = getMoveFlags(move);
+    string result = getSquareName(getMoveFrom(move));
+    result.append(getSquareName(getMoveTo(move)));
 
     if (flags) {
         switch (flags) {
@@ -1626,40 +784,67 @@ string Board::getMoveName(char from, char to, char flags) {
     return result;
 }
 
-void Board::initZobristRandoms() {
-    srand(353);
-
-    for (int i = 0; i < 781; i++) {
-        //generate random 64 bit unsigned integer
-        uint64_t r30, s30, t4;
-        r30 = RAND_MAX * rand() + rand();
-        s30 = RAND_MAX * rand() + rand();
-        t4 = rand() & 0xf;
-        m_zobristRandoms[i] = (s30 << 34) + (r30 << 4) + t4;
-    }
-}
-
 void Board::setZobristKey() {
     m_zobristKeys[m_ply] = 0ull;
+    m_pawnKey = 0ull;
 
     //include the positions for all the pieces
     uint64_t pieceBitboard;
     for (int typeOfPiece = 0; typeOfPiece < 12; typeOfPiece++) {
         pieceBitboard = m_pieces[typeOfPiece];
         while (pieceBitboard) {
-            m_zobristKeys[m_ply] ^= m_zobristRandoms[typeOfPiece * 64 + popLSB(&pieceBitboard)];
+            char square = popLSB(&pieceBitboard);
+            m_zobristKeys[m_ply] ^= lookupTables::ZOBRIST_RANDOMS[typeOfPiece * 64 + square];
+            m_pawnKey ^= lookupTables::ZOBRIST_RANDOMS[typeOfPiece * 64 + square] * ((typeOfPiece == PieceType::WhitePawn) || (typeOfPiece == PieceType::BlackPawn));
         }
     }
 
     //include the side to move
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[768] * m_turn;
+    m_zobristKeys[m_ply] ^= lookupTables::ZOBRIST_RANDOMS[768] * m_turn;
 
     //include castling rights
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[769] * m_castleRights[0];
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[770] * m_castleRights[1];
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[771] * m_castleRights[2];
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[772] * m_castleRights[3];
+    m_zobristKeys[m_ply] ^= lookupTables::ZOBRIST_RANDOMS[769] * m_castleRights[0];
+    m_zobristKeys[m_ply] ^= lookupTables::ZOBRIST_RANDOMS[770] * m_castleRights[1];
+    m_zobristKeys[m_ply] ^= lookupTables::ZOBRIST_RANDOMS[771] * m_castleRights[2];
+    m_zobristKeys[m_ply] ^= lookupTables::ZOBRIST_RANDOMS[772] * m_castleRights[3];
 
     //include en passant square
-    m_zobristKeys[m_ply] ^= m_zobristRandoms[773 + m_enPassantSquare % 8] * (m_enPassantSquare < 64);
+    m_zobristKeys[m_ply] ^= lookupTables::ZOBRIST_RANDOMS[773 + m_enPassantSquare % 8] * (m_enPassantSquare < 64);
+}
+
+//calculate the evaluation terms from scratch, after which they are updated incrementally as moves are made
+void Board::setEvalTerms() {
+    m_material = 0;
+    m_earlyGamePST = 0;
+    m_endGamePST = 0;
+
+    uint64_t pieceBitboard;
+    for (int typeOfPiece = 0; typeOfPiece < 12; typeOfPiece++) {
+        pieceBitboard = m_pieces[typeOfPiece];
+        while (pieceBitboard) {
+            addPieceToEval(typeOfPiece, popLSB(&pieceBitboard));
+        }
+    }
+
+    m_numPieces[0] = popcount(m_pieces[PieceType::White]);
+    m_numPieces[1] = popcount(m_pieces[PieceType::Black]);
+}
+
+//the kings aren't included in the evaluation, as they can never be taken
+void Board::addPieceToEval(char piece, char square) {
+    if ((piece < PieceType::WhiteQueen) || (piece > PieceType::BlackPawn)) {
+        return;
+    }
+    m_material += constants::PIECE_VALUES[piece];
+    m_earlyGamePST += constants::PIECE_SQUARE_TABLES_EARLY_GAME[piece * 64 + square];
+    m_endGamePST += constants::PIECE_SQUARE_TABLES_END_GAME[piece * 64 + square];
+}
+
+void Board::removePieceFromEval(char piece, char square) {
+    if ((piece < PieceType::WhiteQueen) || (piece > PieceType::BlackPawn)) {
+        return;
+    }
+    m_material -= constants::PIECE_VALUES[piece];
+    m_earlyGamePST -= constants::PIECE_SQUARE_TABLES_EARLY_GAME[piece * 64 + square];
+    m_endGamePST -= constants::PIECE_SQUARE_TABLES_END_GAME[piece * 64 + square];
 }
\ No newline at end of file
@@ -5,6 +5,10 @@
 #include <bit>
 
 #include "transpositionTable.h"
+#include "move.h"
+#include "attackTables.h"
+#include "lookupTables.h"
+#include "perftHashTable.h"
 
 using namespace std;
 
@@ -13,6 +17,15 @@ enum PieceType {
     All, White, Black
 };
 
+enum class Color : bool {
+    White = 0, Black = 1
+};
+
+//the moves that a call to generate moves should produce
+enum class MoveType {
+    AllMoves, Captures, Quiets
+};
+
 struct unMakeMoveState {
     uint64_t enPassantBitboard;
     char enPassantSquare;
@@ -21,6 +34,24 @@ struct unMakeMoveState {
     char last50MoveRule;
     //castling
     bool castleRights[4];
+    //evaluation
+    uint64_t pawnKey;
+    int material;
+    int earlyGamePST;
+    int endGamePST;
+    char numPieces[2];
+};
+
+//everything prepareMoveGeneration() works out apart from the attacks of each piece type, so that it can be put back after
+//moves have been made, generated and unmade, instead of being worked out again
+struct moveGenerationState {
+    uint64_t attackingSquares;
+    uint64_t pinnedPieces;
+    uint64_t checkers;
+    uint64_t blockOrCaptureCheckMask;
+    bool check;
+    bool doubleCheck;
+    char checkingPiece;
 };
 
 class Board {
@@ -43,92 +74,90 @@ private:
     //50 move rule
     char m_50MoveRule;
 
-    unsigned char getSquareNum(unsigned char x, unsigned char y);
-
     //attacking squares
+    //these are worked out with the side to move's king taken off the board, so sliding attacks x-ray through the king to
+    //the squares behind it. that is what the king needs to know where it can move to, but it means they aren't the true
+    //attacks of the position for anything else, such as exchange evaluation
     uint64_t m_attackingSquares;
-    uint64_t m_pawnAttackingSquares;
+    uint64_t m_pieceTypeAttacks[12]; //squares attacked by each of the enemy's types of piece, the other side's are left unset
 
     //zobrist
-    uint64_t m_zobristRandoms[781];
-    void initZobristRandoms();
-    uint64_t* m_zobristKeys;
-    void setZobristKey();
+    uint64_t m_zobristKeys[11800];
+    unMakeMoveState m_stateStack[constants::STATE_STACK_SIZE]; //indexed by ply, wrapping around to the start
+    uint64_t m_pawnKey; //zobrist key of just the pawns, used to look up the pawn structure evaluation
+
+    //evaluation terms, updated incrementally as moves are made and unmade
+    int m_material;
+    int m_earlyGamePST; //sum of the piece square table values for the early game
+    int m_endGamePST;
+    char m_numPieces[2]; //number of pieces each side has, used to tell how far through the game it is
+    void setEvalTerms();
+    void addPieceToEval(char piece, char square);
+    void removePieceFromEval(char piece, char square);
 
     //move generation
-    uint64_t* m_rookMovesLookup[64];
-    uint64_t m_rookMovementMasks[64];
-    uint64_t* m_bishopMovesLookup[64];
-    uint64_t m_bishopMovementMasks[64];
-    uint64_t m_castlingEmptySquareBitboards[4]; //squares that must be empty to be allowed to castle
-    uint64_t m_castlingAttackingSquareBitboards[4]; //squares that must not be attacked to be allowed to castle
-    uint64_t m_castlingRookToggleBitboards[4]; //squares that the rook moves from and to while castling
-    uint64_t m_knightMoves[64];
-    uint64_t m_kingMoves[64];
-    uint64_t m_whitePawn1ForwardMoves[64];
-    uint64_t m_blackPawn1ForwardMoves[64];
-    uint64_t m_whitePawn2ForwardMoves[64];
-    uint64_t m_blackPawn2ForwardMoves[64];
-    uint64_t m_whitePawnTakesMoves[64];
-    uint64_t m_blackPawnTakesMoves[64];
-    uint64_t m_whitePawnEnPassantMoves[64];
-    uint64_t m_blackPawnEnPassantMoves[64];
+    const AttackTables* m_attackTables; //sliding piece tables, shared with every other board
     uint64_t m_pinnedPieces;
-    uint64_t* m_alignMasks[64];
+    uint64_t m_checkers; //enemy pieces that are attacking the king
+    uint64_t m_blockOrCaptureCheckMask; //squares that pieces other than the king must move to when in check
     bool m_check;
     bool m_doubleCheck;
     char m_checkingPiece;
-    void initPieceMovementMasksAndTables();
-    void initCastlingBitboards();
-    void calculatePawnMoves();
-    void calculateKnightMoves();
-    void calculateKingMoves();
-    uint64_t calculateRookMoves(unsigned char rookPosition, uint64_t blockerBitboard);
-    uint64_t calculateBishopMoves(unsigned char bishopPosition, uint64_t blockerBitboard);
-    void createRookLookupTable();
-    void createBishopLookupTable();
-    void generateRookMovementMasks(uint64_t* masks);
-    void generateBishopMovementMasks(uint64_t* masks);
-    void calculateAlignMasks();
-    uint64_t* createAllBlockerBitboards(uint64_t movementMask, int* numBlockerBitboards);
-    uint64_t getRookLegalMoves(char square);
-    uint64_t getBishopLegalMoves(char square);
-    uint64_t getQueenLegalMoves(char square);
-    uint64_t getWhitePawnLegalMoves(char square, char kingPosition);
-    uint64_t getBlackPawnLegalMoves(char square, char kingPosition);
-    uint64_t getKnightLegalMoves(char square);
+    template <Color Us, MoveType Type>
+    void generateMoves(MoveList* moves);
+    template <Color Us>
+    uint64_t getPieceLegalMoves(char square, char kingPosition, uint64_t targets);
+    template <Color Us>
+    uint64_t getPawnLegalMoves(char square, char kingPosition);
+    template <Color Us>
     uint64_t getKingLegalMoves(char square);
-    uint64_t getRookLegalMovesCapturesOnly(char square);
-    uint64_t getBishopLegalMovesCapturesOnly(char square);
-    uint64_t getQueenLegalMovesCapturesOnly(char square);
-    uint64_t getWhitePawnLegalMovesCapturesOnly(char square, char kingPosition);
-    uint64_t getBlackPawnLegalMovesCapturesOnly(char square, char kingPosition);
-    uint64_t getKnightLegalMovesCapturesOnly(char square);
-    uint64_t getKingLegalMovesCapturesOnly(char square);
-    uint64_t getRookAttacks(char square);
-    uint64_t getBishopAttacks(char square);
-    uint64_t getQueenAttacks(char square);
-    uint64_t getWhitePawnAttacks(char square);
-    uint64_t getBlackPawnAttacks(char square);
-    uint64_t getKnightAttacks(char square);
-    uint64_t getKingAttacks(char square);
+    template <Color Us>
     bool inCheckAfterEnPassant(char friendlyPawnSquare, char kingPosition);
+    template <Color Us>
+    void addMoves(MoveList* moves, char from, uint64_t pieceMoves);
+    template <Color Us>
     void updateAttackingSquares();
+    template <Color Us>
     void updatePinnedPieces();
+    uint64_t calculatePieceTypeAttacks(char pieceType, uint64_t occupiedSquares);
+    template <Color Us>
+    bool isMoveLegal(Move move);
+
+    //moves are made and unmade by the side that is moving, so that the colour is known at compile time
+    template <Color Us>
+    void makeMove(Move move);
+    template <Color Us>
+    void unMakeMove(Move move);
+    void togglePiece(char piece, uint64_t squares);
+    void addPiece(char piece, char square);
+    void removePiece(char piece, char square);
+    void movePiece(char piece, char from, char to);
 public:
     Board();
     void loadFromFen(string fen);
-    void makeMove(unsigned char from, unsigned char to, unsigned char flags);
-    void getUnMakeMoveState(unMakeMoveState* prevMoveState, char to);
-    void unMakeMove(unsigned char from, unsigned char to, unsigned char flags, unMakeMoveState* prevBoardInfo);
-    void getLegalMoves(unsigned char* numLegalMoves, unsigned char* legalMovesFrom, unsigned char* legalMovesTo, unsigned char* legalMovesFlags);
-    void getCaptureMoves(unsigned char* numLegalMoves, unsigned char* legalMovesFrom, unsigned char* legalMovesTo, unsigned char* legalMovesFlags);
-    uint64_t getLegalMovesBitboardForSquare(char square, unsigned char* numLegalMoves, unsigned char* legalMovesFrom, unsigned char* legalMovesTo);
-    bool isMovePromotion(unsigned char from, unsigned char to, unsigned char* numLegalMoves, unsigned char* legalMovesFrom, unsigned char* legalMovesTo, unsigned char* legalMovesFlags);
-
-    void calculateMagic(uint64_t* magic, char* shift, uint64_t* blockerBitboards, int numBlockerBitboards, uint64_t* keys, uint64_t* fullPieceMoves);
-
-    unsigned long long perft(int depth);
+    void makeMove(Move move);
+    //the state that can't be worked out from the move is kept on the board's own stack, so moves must be unmade in the
+    //reverse order to how they were made
+    void unMakeMove(Move move);
+    void getLegalMoves(MoveList* moves);
+    //works out the attacking squares and pinned pieces of the position, which also updates inCheck()
+    //the staged move generators and isMoveLegal() use them instead of working them out again, so this must be called
+    //before any of them, and again (or the state restored) if moves have been generated in another position since
+    void prepareMoveGeneration();
+    void saveMoveGenerationState(moveGenerationState* state);
+    void restoreMoveGenerationState(const moveGenerationState* state);
+    void getCaptureMoves(MoveList* moves);
+    void getQuietMoves(MoveList* moves);
+    uint64_t getLegalMovesBitboardForSquare(char square, MoveList* moves);
+    bool isMoveLegal(Move move);
+    bool isMovePromotion(unsigned char from, unsigned char to, MoveList* moves);
+
+    //counts the leaf nodes at the depth, using the hash table to skip positions that have already been counted if it
+    //isn't null
+    unsigned long long perft(int depth, PerftHashTable* hashTable = nullptr);
+
+    //calculates the zobrist key and pawn key of the position from scratch, instead of updating them as moves are made
+    void setZobristKey();
 
     string getSquareName(char squareNum);
 
@@ -136,7 +165,7 @@ public:
         return 56 - (squareName[1] - '1') * 8 + squareName[0] - 'a';
     }
 
-    string getMoveName(char from, char to, char flags);
+    string getMoveName(Move move);
 
     inline bool getTurn() {
         return m_turn;
@@ -151,11 +180,14 @@ public:
         return m_eightByEight[squareIndex];
     }
     inline uint64_t getZobristRandom(short index) {
-        return m_zobristRandoms[index];
+        return lookupTables::ZOBRIST_RANDOMS[index];
     }
     inline uint64_t getZobristKey(short ply) {
         return m_zobristKeys[ply];
     }
+    inline uint64_t getPawnKey() {
+        return m_pawnKey;
+    }
     inline bool inCheck() {
         return m_check;
     }
@@ -165,9 +197,36 @@ public:
     inline short getLastTakeOrPawnMove() {
         return m_lastTakeOrPawnMove;
     }
+    //the attacking squares are those of the side that isn't to move, and are updated when moves are generated
+    //sliding attacks go through the side to move's king, so these are only exact for squares not behind it
     inline uint64_t getAttackingSquares() {
         return m_attackingSquares;
     }
+    inline uint64_t getAttackingSquares(char pieceType) {
+        return m_pieceTypeAttacks[pieceType];
+    }
+    inline uint64_t getCheckers() {
+        return m_checkers;
+    }
+    //squares attacked by a set of pawns, white pawns attack towards square 0
+    inline static uint64_t getPawnAttacks(uint64_t pawns, bool side) {
+        constexpr uint64_t notAFile = ~0x0101010101010101ull;
+        constexpr uint64_t notHFile = ~0x8080808080808080ull;
+        return side ? ((pawns & notAFile) << 7) | ((pawns & notHFile) << 9)
+            : ((pawns & notAFile) >> 9) | ((pawns & notHFile) >> 7);
+    }
+    inline int getMaterial() {
+        return m_material;
+    }
+    inline int getEarlyGamePST() {
+        return m_earlyGamePST;
+    }
+    inline int getEndGamePST() {
+        return m_endGamePST;
+    }
+    inline char getNumPieces(bool side) {
+        return m_numPieces[side];
+    }
     inline int getCastleScore() {
         return (m_castleRights[0] || m_castleRights[1] || m_castled[0])
             - (m_castleRights[2] || m_castleRights[3] || m_castled[1]);
@@ -14,7 +14,49 @@ namespace constants {
 
     constexpr int PIECE_VALUES[13] = { 0, 0, 1220, -1220, 397, -397, 375, -375, 613, -613, 100, -100, 0 };
 
+    //pawn structure, indexed by how many ranks a passed pawn has advanced
+    constexpr int PASSED_PAWN_BONUSES[8] = { 0, 5, 10, 20, 35, 60, 100, 0 };
+    constexpr int ISOLATED_PAWN_PENALTY = { 12 };
+    constexpr int DOUBLED_PAWN_PENALTY = { 15 };
+
+    constexpr int PAWN_HASH_SIZE = { 16384 }; //entries per thread
+    constexpr int EVAL_HASH_SIZE = { 65536 }; //entries per thread
+
     constexpr int MAX_DEPTH = { 1000 };
+    constexpr int STATE_STACK_SIZE = { 2048 }; //must be more than the number of moves that are ever made without being unmade
+
+    constexpr int MAX_THREADS = { 256 };
+    constexpr int TIME_CHECK_INTERVAL = { 512 }; //nodes searched between each time the search checks whether its time is up
+
+    //time management
+    constexpr int MOVE_OVERHEAD = { 30 }; //milliseconds kept back for the move to reach the gui
+    constexpr int DEFAULT_MOVES_LEFT = { 50 }; //moves the time on the clock is shared between when there isn't a movestogo
+    constexpr int MAX_BEST_MOVE_STABILITY = { 6 };
+    constexpr int BEST_MOVE_STABILITY_SCALES[MAX_BEST_MOVE_STABILITY + 1] = { 150, 125, 105, 95, 85, 75, 65 }; //percentage of the optimum time to use, indexed by how many depths in a row the best move hasn't changed
+    constexpr int MAX_SCORE_DROP = { 100 }; //largest fall in the score, in centipawns, that the time is lengthened for
+
+    constexpr int DEFAULT_HASH_SIZE = { 1024 };
+    constexpr int MAX_HASH_SIZE = { 1048576 };
+    constexpr int PERFT_HASH_SIZE = { 256 }; //megabytes
+
+    //positions searched by the bench command, covering openings, middlegames and endgames
+    constexpr int DEFAULT_BENCH_DEPTH = { 8 };
+    constexpr int DEFAULT_BENCH_HASH_SIZE = { 16 };
+    constexpr int NUM_BENCH_POSITIONS = { 12 };
+    constexpr const char* BENCH_POSITIONS[NUM_BENCH_POSITIONS] = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 10",
+        "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+        "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1",
+        "2rq1rk1/pp1bppbp/2np1np1/8/3NP3/1BN1BP2/PPPQ2PP/2KR3R b - - 0 11",
+        "r1bq1rk1/pp2nppp/2n1p3/3pP3/1b1P4/2NB1N2/PP3PPP/R1BQK2R w KQ - 3 9",
+        "6k1/5ppp/p3p3/1p1pP3/3P4/P1r2P2/1P3KPP/3R4 w - - 0 28",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "8/8/1p1k4/p1p2p2/P1P2P2/1P1K4/8/8 w - - 0 40",
+        "4k3/8/8/8/8/8/4P3/4K3 w - - 0 1"
+    };
 
     constexpr int PIECE_SQUARE_TABLES_EARLY_GAME[64 * 12] = {  // White King
 		                                                          -30,-40,-40,-50,-50,-40,-40,-30,
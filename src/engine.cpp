@@ -3,10 +3,30 @@
 #include <fstream>
 #include <chrono>
 #include <thread>
+#include <algorithm>
+#include <memory>
+#include <mutex>
 
 #include "engine.h"
 #include "constants.h"
 
+Engine::Engine() : m_board(), m_transpositionTable(constants::DEFAULT_HASH_SIZE), m_search(&m_board, &m_transpositionTable), m_lastEval(0),
+	m_numThreads(1), m_stopHelpers(true), m_searching(false), m_quit(false), m_deepening(false), m_searchLimits(), m_stopSearch(false), m_cancelSearch(false), m_pondering(false) {
+	//started last, so that everything it uses has been initialised
+	m_searchThread = std::thread(&Engine::searchThreadLoop, this);
+}
+
+Engine::~Engine() {
+	{
+		std::lock_guard<std::mutex> lock(m_searchMutex);
+		m_quit = true;
+	}
+	m_stopSearch = true;
+	m_cancelSearch = true;
+	m_searchCondition.notify_all();
+	m_searchThread.join();
+}
+
 void Engine::receiveCommand(string command) {
 	// ofstream myfile;
 	// myfile.open("log.txt", ios::app);
@@ -18,28 +38,55 @@ void Engine::receiveCommand(string command) {
 	string word;
 	stream >> word;
 
+	//the gui shouldn't send anything other than stop, isready and quit while the engine is searching, but if it does
+	//the search is stopped before the command is carried out
+	if ((word == "stop") || (word == "quit") || (word == "go") || (word == "position") || (word == "setoption") || (word == "ucinewgame") || (word == "bench")) {
+		stopSearch();
+	}
+
 	if (word == "go") {
-		int time = 0;
+		SearchLimits limits = {};
 		string timeWord = m_board.getTurn() ? "btime" : "wtime";
-		//find the time left
+		string incrementWord = m_board.getTurn() ? "binc" : "winc";
 		while (stream >> word) {
 			if (word == timeWord) {
-				stream >> word;
-				time = stoi(word);
+				stream >> limits.time;
+			}
+			else if (word == incrementWord) {
+				stream >> limits.increment;
+			}
+			else if (word == "movestogo") {
+				stream >> limits.movesToGo;
+			}
+			else if (word == "movetime") {
+				stream >> limits.moveTime;
+			}
+			else if (word == "depth") {
+				stream >> limits.depth;
+			}
+			else if (word == "nodes") {
+				stream >> limits.nodes;
+			}
+			else if (word == "infinite") {
+				limits.infinite = true;
+			}
+			else if (word == "ponder") {
+				limits.ponder = true;
+			}
+			//go perft [depth] counts the positions instead of searching
+			else if (word == "perft") {
+				int depth = 1;
+				stream >> depth;
+				perft(std::max(depth, 1));
+				return;
 			}
 		}
 
-		//calculate the best move
-		unsigned char from, to, flags;
-		int currentDepth, eval;
-		bool cancelSearch = false;
-		iterativeDeepeningSearch(time, &currentDepth, &cancelSearch, &eval, &from, &to, &flags);
+		startSearch(limits);
+	}
 
-		//send bestmove command
-		string bestMove = "bestmove ";
-		bestMove.append(m_board.getMoveName(from, to, flags));
-		bestMove.append("\n");
-		cout << bestMove;
+	if (word == "ponderhit") {
+		ponderhit();
 	}
 
 	if (word == "position") {
@@ -101,77 +148,320 @@ void Engine::receiveCommand(string command) {
 					int timeSearched = chrono::duration_cast<chrono::milliseconds>(chrono::high_resolution_clock::now() - tp).count();
 				}*/
 
-				m_board.makeMove(from, to, flags);
+				m_board.makeMove(encodeMove(from, to, flags));
 			}
 		}
 	}
 
+	if (word == "bench") {
+		int depth = constants::DEFAULT_BENCH_DEPTH;
+		int hashSize = constants::DEFAULT_BENCH_HASH_SIZE;
+		int numThreads = 1;
+		stream >> depth >> hashSize >> numThreads;
+		bench(std::clamp(depth, 1, constants::MAX_DEPTH - 1), std::clamp(hashSize, 1, constants::MAX_HASH_SIZE), std::clamp(numThreads, 1, constants::MAX_THREADS));
+	}
+
+	if (word == "setoption") {
+		string name = "";
+		string value = "";
+		//read the name of the option, which can contain spaces, and then its value
+		stream >> word;
+		while ((stream >> word) && (word != "value")) {
+			if (!name.empty()) {
+				name.append(" ");
+			}
+			name.append(word);
+		}
+		stream >> value;
+		//a value that isn't a number, or is too big to be read, leaves the option as it was
+		int number;
+		bool isNumber = static_cast<bool>(stringstream(value) >> number);
+
+		if ((name == "Threads") && isNumber) {
+			setNumThreads(number);
+		}
+		else if ((name == "Hash") && isNumber) {
+			m_transpositionTable.resize(std::clamp(number, 1, constants::MAX_HASH_SIZE));
+		}
+		else if (name == "Clear Hash") {
+			m_transpositionTable.clear();
+		}
+	}
+
 	if (word == "isready") {
+		//gives the table a chance to be allocated before the gui starts the clock
+		//a running search has already allocated it, and is using it from the search thread. searches are only started
+		//from this thread, so one can't start between the check and the allocation
+		bool searching;
+		{
+			std::lock_guard<std::mutex> lock(m_searchMutex);
+			searching = m_searching;
+		}
+		if (!searching) {
+			m_transpositionTable.allocate();
+		}
 		cout << "readyok\n";
 	}
 
 	if (word == "ucinewgame") {
-		//i think it should reset things like the transposition table here
+		m_transpositionTable.clear();
+		m_lastEval = 0;
 	}
 
 	if (word == "uci") {
 		cout << "id name Sunstone 1.16\n";
 		cout << "id author Bertie Cartwright\n\n";
+		cout << "option name Threads type spin default 1 min 1 max " << constants::MAX_THREADS << "\n";
+		cout << "option name Hash type spin default " << constants::DEFAULT_HASH_SIZE << " min 1 max " << constants::MAX_HASH_SIZE << "\n";
+		cout << "option name Clear Hash type button\n";
+		cout << "option name Ponder type check default false\n";
 		cout << "uciok\n";
 	}
 }
 
-void Engine::iterativeDeepeningSearch(int time, int* currentDepth, bool* cancelSearch, int* eval, unsigned char* bestMoveFrom, unsigned char* bestMoveTo, unsigned char* bestMoveFlags) {
-	auto startTime = chrono::high_resolution_clock::now();
-	int timeSearched = 0;
-	int targetTime = time == 0 ? 10000 : time / 70;
-	int maxTime = time == 0 ? 10000 : time / 15;
+void Engine::searchThreadLoop() {
+	std::unique_lock<std::mutex> lock(m_searchMutex);
+	while (true) {
+		m_searchCondition.wait(lock, [this] { return m_searching || m_quit; });
+		if (m_quit) {
+			return;
+		}
+
+		//the search doesn't need the lock, and holding it would stop the uci thread from waiting for the search
+		lock.unlock();
+		go(m_searchLimits);
+		lock.lock();
+
+		m_searching = false;
+		m_searchCondition.notify_all();
+	}
+}
+
+void Engine::startSearch(const SearchLimits& limits) {
+	//allocating and clearing a large table takes a while, so it is done before the clock is started, and on this thread
+	//while no search is running, so that the search thread never touches the allocation
+	m_transpositionTable.allocate();
+	{
+		std::lock_guard<std::mutex> lock(m_searchMutex);
+		m_searchLimits = limits;
+		m_timeManager.start(limits);
+		m_pondering = limits.ponder;
+		m_stopSearch = false;
+		m_cancelSearch = false;
+		m_searching = true;
+		m_deepening = true;
+	}
+	m_searchCondition.notify_all();
+}
+
+//the opponent played the expected move, so the ponder search carries on as a normal timed search, keeping everything it
+//has searched so far
+void Engine::ponderhit() {
+	std::lock_guard<std::mutex> lock(m_searchMutex);
+	if (!m_searching || !m_pondering) {
+		return;
+	}
+	m_timeManager.ponderhit();
+	//once the loop has finished the stop time has been cleared, and setting it again would end the next search early
+	if (m_deepening && m_timeManager.isTimed()) {
+		m_search.setStopTime(m_timeManager.getStopTime());
+	}
+	m_pondering = false;
+	//wakes the search thread if it has already finished and is waiting to send its best move
+	m_searchCondition.notify_all();
+}
 
+//stops the search if there is one, and waits for it to send its best move
+void Engine::stopSearch() {
+	{
+		std::lock_guard<std::mutex> lock(m_searchMutex);
+		m_stopSearch = true;
+		m_cancelSearch = true;
+	}
+	m_searchCondition.notify_all();
+	waitForSearch();
+}
+
+void Engine::waitForSearch() {
+	std::unique_lock<std::mutex> lock(m_searchMutex);
+	m_searchCondition.wait(lock, [this] { return !m_searching; });
+}
+
+//the loop has to be marked as finished before its stop time is cleared, so that a ponderhit can't set it again afterwards
+void Engine::endDeepening() {
+	{
+		std::lock_guard<std::mutex> lock(m_searchMutex);
+		m_deepening = false;
+	}
+	m_search.clearStopTime();
+	m_search.setNodeLimit(0);
+}
+
+//searches the current position and sends the best move
+void Engine::go(const SearchLimits& limits) {
+	Move bestMove;
+	int currentDepth, eval;
+	iterativeDeepeningSearch(limits, &currentDepth, &eval, &bestMove);
+
+	//an infinite or ponder search mustn't send its best move until it is told to stop or the ponder move is played, even if
+	//it has run out of depths to search
+	{
+		std::unique_lock<std::mutex> lock(m_searchMutex);
+		m_searchCondition.wait(lock, [&] { return m_stopSearch || m_quit || !(limits.infinite || m_pondering); });
+	}
+	m_pondering = false;
+
+	string bestMoveCommand = "bestmove ";
+	bestMoveCommand.append(m_board.getMoveName(bestMove));
+	Move ponderMove = getPonderMove(bestMove);
+	if (ponderMove != NULL_MOVE) {
+		bestMoveCommand.append(" ponder ");
+		bestMoveCommand.append(m_board.getMoveName(ponderMove));
+	}
+	bestMoveCommand.append("\n");
+	cout << bestMoveCommand << flush;
+}
+
+//the move the opponent is expected to reply with, which is the best move the transposition table has for the position
+//after the best move, or no move if there isn't a legal one
+Move Engine::getPonderMove(Move bestMove) {
+	m_board.makeMove(bestMove);
+	int eval;
+	Move ponderMove = NULL_MOVE;
+	m_transpositionTable.probeHash(&eval, m_board.getZobristKey(m_board.getPly()), 0, -std::numeric_limits<int>::max() / 2, std::numeric_limits<int>::max() / 2, &ponderMove);
+	m_board.prepareMoveGeneration();
+	bool legal = (ponderMove != NULL_MOVE) && m_board.isMoveLegal(ponderMove);
+	m_board.unMakeMove(bestMove);
+	return legal ? ponderMove : NULL_MOVE;
+}
+
+void Engine::iterativeDeepeningSearch(const SearchLimits& limits, int* currentDepth, int* eval, Move* bestMove) {
+	int maxDepth = limits.depth > 0 ? std::min(limits.depth, constants::MAX_DEPTH - 1) : constants::MAX_DEPTH - 1;
+
+	m_transpositionTable.newSearch();
+	m_search.clearStopTime();
+	m_search.setNodeLimit(0);
 	m_search.resetNodeCount();
+	for (Search& helperSearch : m_helperSearches) {
+		helperSearch.resetNodeCount();
+	}
 
 	*eval = 0;
 	*currentDepth = 0;
-	int bestMoveNum = 0;
 
 	// Check for only 1 legal move
-	if (m_search.checkForSingleLegalMove(bestMoveFrom, bestMoveTo, bestMoveFlags) && (time != 0)) {
-		timeSearched = chrono::duration_cast<chrono::milliseconds>(chrono::high_resolution_clock::now() - startTime).count();
+	if (m_search.checkForSingleLegalMove(bestMove) && m_timeManager.usesClock() && !m_pondering) {
 		m_lastEval +=
 			2 * (m_lastEval >= std::numeric_limits<int>::max() / 2 - constants::MAX_DEPTH - 1)
 			- 2 * (m_lastEval <= -std::numeric_limits<int>::max() / 2 + constants::MAX_DEPTH + 1);
-		printInfo(timeSearched, 1, m_lastEval);
+		printInfo(m_timeManager.getTimeSearched(), 1, m_lastEval);
+		endDeepening();
 
 		return;
 	}
 
-	while (!(*cancelSearch)) {
-		if ((timeSearched > targetTime) || ((std::abs(*eval) >= std::numeric_limits<int>::max() / 2 - constants::MAX_DEPTH) && (time != 0))) {
-			m_lastEval = *eval;
-			return;
-		}
+	std::vector<std::thread> helpers;
+	startHelpers(&helpers);
 
+	//the search stops itself once the hard limit or the node limit has passed, and the time manager decides whether to
+	//start each new depth
+	//while pondering there is no time limit, until ponderhit sets one
+	while ((*currentDepth < maxDepth) && !((std::abs(*eval) >= std::numeric_limits<int>::max() / 2 - constants::MAX_DEPTH) && m_timeManager.usesClock() && !m_pondering)) {
 		(*currentDepth)++;
-
-		std::thread worker(&Engine::work, this, cancelSearch, bestMoveFrom, bestMoveTo, bestMoveFlags, *currentDepth, &bestMoveNum, eval);
-		while (!(*cancelSearch)) {
-			std::this_thread::sleep_for(std::chrono::microseconds(targetTime * 2));
-			timeSearched = chrono::duration_cast<chrono::milliseconds>(chrono::high_resolution_clock::now() - startTime).count();
-			if (timeSearched > maxTime) {
-				*cancelSearch = true;
-				*currentDepth -= 1;
+		//the first depth only takes a moment, and is always finished so that there is a best move to send
+		if (*currentDepth == 2) {
+			if (m_timeManager.isTimed() && !m_pondering) {
+				m_search.setStopTime(m_timeManager.getStopTime());
 			}
+			//only the main search counts towards the node limit, and the helpers are stopped when it finishes
+			m_search.setNodeLimit(limits.nodes);
 		}
-		worker.join();
-		timeSearched = chrono::duration_cast<chrono::milliseconds>(chrono::high_resolution_clock::now() - startTime).count();
-		if (timeSearched < targetTime) {
-			*cancelSearch = false;
+		m_search.rootSearch(&m_cancelSearch, bestMove, *currentDepth, eval);
+
+		//a depth that was stopped part of the way through hasn't been completed
+		if (m_cancelSearch) {
+			(*currentDepth)--;
+			printInfo(m_timeManager.getTimeSearched(), *currentDepth, *eval);
+			break;
 		}
-		printInfo(timeSearched, *currentDepth, *eval);
+		printInfo(m_timeManager.getTimeSearched(), *currentDepth, *eval);
+
+		m_timeManager.update(*bestMove, *eval);
+		if (!m_pondering && !m_timeManager.shouldStartNextDepth()) {
+			break;
+		}
+	}
+	endDeepening();
+	m_lastEval = *eval;
+
+	stopHelpers(&helpers);
+}
+
+//start the helper threads, which keep searching deeper and deeper until the main search has finished
+void Engine::startHelpers(std::vector<std::thread>* helpers) {
+	m_stopHelpers = false;
+	for (int i = 0; i < m_numThreads - 1; i++) {
+		m_helperBoards[i] = m_board;
+		helpers->emplace_back(&Engine::helperWork, this, i);
+	}
+}
+
+void Engine::stopHelpers(std::vector<std::thread>* helpers) {
+	m_stopHelpers = true;
+	for (std::thread& helper : *helpers) {
+		helper.join();
+	}
+	helpers->clear();
+}
+
+void Engine::helperWork(int helperNum) {
+	Move bestMove;
+	int eval;
+	//start every other helper a ply deeper so that the threads don't all search the same tree in lockstep
+	for (int depth = 1 + helperNum % 2; (!m_stopHelpers) && (depth < constants::MAX_DEPTH); depth++) {
+		m_helperSearches[helperNum].rootSearch(&m_stopHelpers, &bestMove, depth, &eval);
 	}
 }
 
-void Engine::work(bool* cancelSearch, unsigned char* from, unsigned char* to, unsigned char* flags, int depth, int* bestMoveNum, int* eval) {
-	m_search.rootSearch(cancelSearch, from, to, flags, depth, bestMoveNum, eval);
+void Engine::setNumThreads(int numThreads) {
+	m_numThreads = std::clamp(numThreads, 1, constants::MAX_THREADS);
+
+	//the searches point at the boards, so the boards must all be allocated before the searches are created
+	m_helperSearches.clear();
+	m_helperBoards.assign(m_numThreads - 1, m_board);
+	for (int i = 0; i < m_numThreads - 1; i++) {
+		m_helperSearches.emplace_back(&m_helperBoards[i], &m_transpositionTable);
+	}
+}
+
+long long Engine::getNodeCount() {
+	long long nodeCount = m_search.getNodeCount();
+	for (Search& helperSearch : m_helperSearches) {
+		nodeCount += helperSearch.getNodeCount();
+	}
+	return nodeCount;
+}
+
+//only printed by bench, so that the gui isn't sent it after every search
+void Engine::printEvalStats() {
+	long long numProbes = m_search.getNumEvalProbes();
+	long long numHits = m_search.getNumEvalHits();
+	for (Search& helperSearch : m_helperSearches) {
+		numProbes += helperSearch.getNumEvalProbes();
+		numHits += helperSearch.getNumEvalHits();
+	}
+
+	string info = "info string eval cache hits ";
+	info.append(to_string(numHits));
+	info.append(" of ");
+	info.append(to_string(numProbes));
+	if (numProbes > 0) {
+		info.append(" (");
+		info.append(to_string(numHits * 100 / numProbes));
+		info.append("%)");
+	}
+	info.append("\n");
+	cout << info;
 }
 
 void Engine::printInfo(int timeSearched, int currentDepth, int eval) {
@@ -194,17 +484,122 @@ void Engine::printInfo(int timeSearched, int currentDepth, int eval) {
 		info.append(to_string(eval));
 	}
 	info.append(" nodes ");
-	info.append(to_string(m_search.getNodeCount()));
+	long long nodeCount = getNodeCount();
+	info.append(to_string(nodeCount));
 	info.append(" nps ");
 	if (timeSearched > 0) {
-		info.append(to_string(m_search.getNodeCount() * 1000 / timeSearched));
+		info.append(to_string(nodeCount * 1000 / timeSearched));
 	}
 	else {
-		info.append(to_string(m_search.getNodeCount() * 1000));
+		info.append(to_string(nodeCount * 1000));
 	}
+	info.append(" hashfull ");
+	info.append(to_string(m_transpositionTable.getHashfull()));
 	info.append(" time ");
 	info.append(to_string(timeSearched));
 
 	info.append("\n");
 	cout << info;
+}
+
+//prints the number of positions after each root move and then the total, splitting the root moves between the threads
+void Engine::perft(int depth) {
+	auto startTime = chrono::high_resolution_clock::now();
+
+	MoveList rootMoves;
+	m_board.getLegalMoves(&rootMoves);
+	std::vector<unsigned long long> counts(rootMoves.size(), 0);
+	//clearing the hash table takes longer than a shallow perft, so it is only used for deeper ones
+	bool useHashTable = depth > 4;
+	PerftHashTable hashTable(useHashTable ? constants::PERFT_HASH_SIZE : 0);
+
+	//every thread works on its own copy of the board, taking the next root move that hasn't been counted yet
+	std::atomic<int> nextRootMove(0);
+	std::vector<Board> boards(std::min(m_numThreads, std::max(rootMoves.size(), 1)), m_board);
+	std::vector<std::thread> threads;
+	for (Board& board : boards) {
+		threads.emplace_back(&Engine::perftWork, this, &board, depth, &rootMoves, &nextRootMove, &counts, useHashTable ? &hashTable : nullptr);
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	unsigned long long numPositions = 0;
+	for (int moveNum = 0; moveNum < rootMoves.size(); moveNum++) {
+		cout << m_board.getMoveName(rootMoves.getMove(moveNum)) << ": " << counts[moveNum] << "\n";
+		numPositions += counts[moveNum];
+	}
+
+	long long timeSearched = chrono::duration_cast<chrono::milliseconds>(chrono::high_resolution_clock::now() - startTime).count();
+	cout << "\nNodes searched: " << numPositions << "\n";
+	cout << "info string perft time " << timeSearched << " nps " << numPositions * 1000 / std::max(timeSearched, 1ll) << "\n\n";
+}
+
+void Engine::perftWork(Board* board, int depth, MoveList* rootMoves, std::atomic<int>* nextRootMove, std::vector<unsigned long long>* counts, PerftHashTable* hashTable) {
+	int moveNum;
+	while ((moveNum = nextRootMove->fetch_add(1)) < rootMoves->size()) {
+		Move move = rootMoves->getMove(moveNum);
+		board->makeMove(move);
+		(*counts)[moveNum] = board->perft(depth - 1, hashTable);
+		board->unMakeMove(move);
+	}
+}
+
+//searches every bench position to a fixed depth and prints the total number of nodes and the nodes per second
+//with one thread the number of nodes is always the same for the same version of the search, so it can be used to check
+//that a change that should only make the engine faster hasn't changed the search
+void Engine::bench(int depth, int hashSize, int numThreads) {
+	//put the position, hash size and threads back afterwards, so that bench can be run in the middle of a uci session
+	auto savedBoard = std::make_unique<Board>(m_board);
+	unsigned long long savedHashSize = m_transpositionTable.getSize();
+	int savedNumThreads = m_numThreads;
+	m_transpositionTable.resize(hashSize);
+	m_transpositionTable.allocate();
+	setNumThreads(numThreads);
+	m_search.resetEvalStats();
+	for (Search& helperSearch : m_helperSearches) {
+		helperSearch.resetEvalStats();
+	}
+
+	auto startTime = chrono::high_resolution_clock::now();
+	long long totalNodes = 0;
+	for (int i = 0; i < constants::NUM_BENCH_POSITIONS; i++) {
+		m_transpositionTable.clear();
+		m_board.loadFromFen(constants::BENCH_POSITIONS[i]);
+		Move bestMove = NULL_MOVE;
+		int eval;
+		searchToDepth(depth, &bestMove, &eval);
+
+		long long nodeCount = getNodeCount();
+		totalNodes += nodeCount;
+		cout << "info string position " << i + 1 << "/" << constants::NUM_BENCH_POSITIONS << " nodes " << nodeCount << " bestmove " << m_board.getMoveName(bestMove) << "\n";
+	}
+	long long timeSearched = chrono::duration_cast<chrono::milliseconds>(chrono::high_resolution_clock::now() - startTime).count();
+	printEvalStats();
+
+	cout << "\n===========================\n";
+	cout << "Total time (ms) : " << timeSearched << "\n";
+	cout << "Nodes searched  : " << totalNodes << "\n";
+	cout << "Nodes/second    : " << totalNodes * 1000 / std::max(timeSearched, 1ll) << "\n";
+
+	m_board = *savedBoard;
+	m_transpositionTable.resize(savedHashSize);
+	setNumThreads(savedNumThreads);
+}
+
+//searches the current position to a fixed depth with all of the threads, without any time limit
+void Engine::searchToDepth(int depth, Move* bestMove, int* eval) {
+	m_transpositionTable.newSearch();
+	m_search.resetNodeCount();
+	for (Search& helperSearch : m_helperSearches) {
+		helperSearch.resetNodeCount();
+	}
+
+	std::vector<std::thread> helpers;
+	startHelpers(&helpers);
+	m_cancelSearch = false;
+	for (int currentDepth = 1; currentDepth <= depth; currentDepth++) {
+		m_search.rootSearch(&m_cancelSearch, bestMove, currentDepth, eval);
+	}
+	stopHelpers(&helpers);
 }
\ No newline at end of file
@@ -1,21 +1,71 @@
 #pragma once
 
 #include <string>
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include "board.h"
 #include "search.h"
+#include "transpositionTable.h"
+#include "perftHashTable.h"
+#include "timeManager.h"
+#include "constants.h"
 
 class Engine {
 private:
 	Board m_board;
+	TranspositionTable m_transpositionTable;
     Search m_search;
+	TimeManager m_timeManager;
 	int m_lastEval;
 
-	void iterativeDeepeningSearch(int time, int* currentDepth, bool* cancelSearch, int* eval, unsigned char* bestMoveFrom, unsigned char* bestMoveTo, unsigned char* bestMoveFlags);
+	//lazy smp helper threads, each searching its own copy of the board and sharing the transposition table
+	int m_numThreads;
+	std::vector<Board> m_helperBoards;
+	std::deque<Search> m_helperSearches;
+	std::atomic<bool> m_stopHelpers;
+
+	//the search runs on a thread that lives as long as the engine, which waits for a go command to wake it up
+	std::thread m_searchThread;
+	std::mutex m_searchMutex;
+	std::condition_variable m_searchCondition;
+	bool m_searching; //protected by m_searchMutex
+	bool m_quit; //protected by m_searchMutex
+	bool m_deepening; //the iterative deepening loop is still running, so ponderhit can give it a stop time. protected by m_searchMutex
+	SearchLimits m_searchLimits;
+	std::atomic<bool> m_stopSearch; //stop or quit was received, which is the only thing that ends an infinite or ponder search
+	//the search has to end part of the way through a depth, because it was stopped or reached its time or node limit
+	std::atomic<bool> m_cancelSearch;
+	std::atomic<bool> m_pondering; //the search is on the opponent's time, and has no time limit until ponderhit
+
+	void searchThreadLoop();
+	void startSearch(const SearchLimits& limits);
+	void stopSearch();
+	void ponderhit();
+	Move getPonderMove(Move bestMove);
+	void waitForSearch();
+	void endDeepening();
+	void go(const SearchLimits& limits);
+	void iterativeDeepeningSearch(const SearchLimits& limits, int* currentDepth, int* eval, Move* bestMove);
 	void printInfo(int timeSearched, int currentDepth, int eval);
-	void work(bool* cancelSearch, unsigned char* from, unsigned char* to, unsigned char* flags, int depth, int* bestMoveNum, int* eval);
+	void printEvalStats();
+	void setNumThreads(int numThreads);
+	void startHelpers(std::vector<std::thread>* helpers);
+	void stopHelpers(std::vector<std::thread>* helpers);
+	void helperWork(int helperNum);
+	void searchToDepth(int depth, Move* bestMove, int* eval);
+	void bench(int depth, int hashSize, int numThreads);
+	long long getNodeCount();
+	void perft(int depth);
+	void perftWork(Board* board, int depth, MoveList* rootMoves, std::atomic<int>* nextRootMove, std::vector<unsigned long long>* counts, PerftHashTable* hashTable);
 
 public:
-	Engine() : m_board(), m_search(&m_board), m_lastEval(0) {}
+	Engine();
+	~Engine();
+	//returns straight away when a search is started, and the best move is sent by the search thread when it finishes
 	void receiveCommand(std::string command);
 };
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+struct evalHashEntry {
+    uint64_t key;
+    int eval;
+};
+
+//caches evaluations by zobrist key, which is used for both the pawn structure and the full static evaluation
+//every search thread has its own tables, so the entries don't need to be protected from other threads
+class EvalHashTable {
+private:
+    std::vector<evalHashEntry> m_table;
+    uint64_t m_indexMask;
+
+public:
+    //size in entries, which must be a power of 2
+    //an empty entry has a key of 0, which is also the pawn key of a position with no pawns, whose pawn evaluation is 0
+    EvalHashTable(int size) : m_table(size, { 0ull, 0 }), m_indexMask(size - 1) {}
+
+    inline bool probe(uint64_t key, int* eval) {
+        evalHashEntry* entry = &m_table[key & m_indexMask];
+        *eval = entry->eval;
+        return entry->key == key;
+    }
+
+    inline void record(uint64_t key, int eval) {
+        evalHashEntry* entry = &m_table[key & m_indexMask];
+        entry->key = key;
+        entry->eval = eval;
+    }
+};
\ No newline at end of file
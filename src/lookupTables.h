@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstdint>
+
+//move tables for the non sliding pieces, the align masks and the zobrist randoms
+//they are the same for every board, so they are all generated while compiling instead of every time a board is created
+namespace lookupTables {
+    template <int Size>
+    struct BitboardTable {
+        uint64_t bitboards[Size];
+
+        constexpr const uint64_t& operator[](int index) const {
+            return bitboards[index];
+        }
+    };
+
+    //bitboard of the square (x, y) if it is on the board, otherwise an empty bitboard
+    constexpr uint64_t getSquareBitboard(int x, int y) {
+        return ((x >= 0) && (x < 8) && (y >= 0) && (y < 8)) ? 1ull << (y * 8 + x) : 0ull;
+    }
+
+    constexpr BitboardTable<64> generateLeaperMoves(const int* xOffsets, const int* yOffsets) {
+        BitboardTable<64> table = {};
+        for (int square = 0; square < 64; square++) {
+            for (int i = 0; i < 8; i++) {
+                table.bitboards[square] |= getSquareBitboard(square % 8 + xOffsets[i], square / 8 + yOffsets[i]);
+            }
+        }
+        return table;
+    }
+
+    constexpr int KNIGHT_X_OFFSETS[8] = { 1, 2, 2, 1, -1, -2, -2, -1 };
+    constexpr int KNIGHT_Y_OFFSETS[8] = { 2, 1, -1, -2, -2, -1, 1, 2 };
+    constexpr int KING_X_OFFSETS[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+    constexpr int KING_Y_OFFSETS[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+
+    constexpr BitboardTable<64> KNIGHT_MOVES = generateLeaperMoves(KNIGHT_X_OFFSETS, KNIGHT_Y_OFFSETS);
+    constexpr BitboardTable<64> KING_MOVES = generateLeaperMoves(KING_X_OFFSETS, KING_Y_OFFSETS);
+
+    //white pawns move towards square 0 and black pawns towards square 63
+    //pawns can never be on their first or last rank, so those squares are left empty
+    constexpr BitboardTable<64> generatePawnMoves(int direction, bool pushes, bool captures) {
+        BitboardTable<64> table = {};
+        for (int square = 8; square < 56; square++) {
+            int x = square % 8;
+            int y = square / 8;
+            if (pushes) {
+                table.bitboards[square] |= getSquareBitboard(x, y + direction);
+            }
+            if (captures) {
+                table.bitboards[square] |= getSquareBitboard(x - 1, y + direction) | getSquareBitboard(x + 1, y + direction);
+            }
+        }
+        return table;
+    }
+
+    //double pushes and en passant captures can only be made from one rank, so the rest of the table is empty
+    constexpr BitboardTable<64> generatePawnRankMoves(int direction, int rank, int distance, bool captures) {
+        BitboardTable<64> table = {};
+        for (int x = 0; x < 8; x++) {
+            if (captures) {
+                table.bitboards[rank * 8 + x] = getSquareBitboard(x - 1, rank + direction) | getSquareBitboard(x + 1, rank + direction);
+            }
+            else {
+                table.bitboards[rank * 8 + x] = getSquareBitboard(x, rank + direction * distance);
+            }
+        }
+        return table;
+    }
+
+    constexpr BitboardTable<64> WHITE_PAWN_1_FORWARD_MOVES = generatePawnMoves(-1, true, false);
+    constexpr BitboardTable<64> BLACK_PAWN_1_FORWARD_MOVES = generatePawnMoves(1, true, false);
+    constexpr BitboardTable<64> WHITE_PAWN_2_FORWARD_MOVES = generatePawnRankMoves(-1, 6, 2, false);
+    constexpr BitboardTable<64> BLACK_PAWN_2_FORWARD_MOVES = generatePawnRankMoves(1, 1, 2, false);
+    constexpr BitboardTable<64> WHITE_PAWN_TAKES_MOVES = generatePawnMoves(-1, false, true);
+    constexpr BitboardTable<64> BLACK_PAWN_TAKES_MOVES = generatePawnMoves(1, false, true);
+    constexpr BitboardTable<64> WHITE_PAWN_EN_PASSANT_MOVES = generatePawnRankMoves(-1, 3, 1, true);
+    constexpr BitboardTable<64> BLACK_PAWN_EN_PASSANT_MOVES = generatePawnRankMoves(1, 4, 1, true);
+
+    //indexed by castle, in the same order as the castle rights
+    constexpr uint64_t CASTLING_EMPTY_SQUARES[4] = { 14ull << 56, 96ull << 56, 14ull, 96ull }; //squares that must be empty to be allowed to castle
+    constexpr uint64_t CASTLING_ATTACKING_SQUARES[4] = { 28ull << 56, 112ull << 56, 28ull, 112ull }; //squares that must not be attacked to be allowed to castle
+    constexpr uint64_t CASTLING_ROOK_TOGGLES[4] = { 9ull << 56, 160ull << 56, 9ull, 160ull }; //squares that the rook moves from and to while castling
+
+    //mask of the line through two squares, from the first square to the edge of the board, or 0 if they aren't on a line
+    constexpr BitboardTable<64 * 64> generateAlignMasks() {
+        BitboardTable<64 * 64> table = {};
+        for (int square = 0; square < 64; square++) {
+            for (int xOffset = -1; xOffset <= 1; xOffset++) {
+                for (int yOffset = -1; yOffset <= 1; yOffset++) {
+                    if ((xOffset == 0) && (yOffset == 0)) {
+                        continue;
+                    }
+                    uint64_t line = 0ull;
+                    for (int distance = 1; getSquareBitboard(square % 8 + xOffset * distance, square / 8 + yOffset * distance); distance++) {
+                        line |= getSquareBitboard(square % 8 + xOffset * distance, square / 8 + yOffset * distance);
+                    }
+                    //every square along the line shares the line's mask
+                    for (int distance = 1; getSquareBitboard(square % 8 + xOffset * distance, square / 8 + yOffset * distance); distance++) {
+                        table.bitboards[square * 64 + (square / 8 + yOffset * distance) * 8 + square % 8 + xOffset * distance] = line;
+                    }
+                }
+            }
+        }
+        return table;
+    }
+
+    constexpr BitboardTable<64 * 64> ALIGN_MASKS = generateAlignMasks();
+
+    inline uint64_t getAlignMask(char square1, char square2) {
+        return ALIGN_MASKS[square1 * 64 + square2];
+    }
+
+    //splitmix64, which is simple enough to run at compile time and gives the same numbers on every compiler
+    constexpr uint64_t nextRandom(uint64_t* state) {
+        *state += 0x9e3779b97f4a7c15ull;
+        uint64_t random = *state;
+        random = (random ^ (random >> 30)) * 0xbf58476d1ce4e5b9ull;
+        random = (random ^ (random >> 27)) * 0x94d049bb133111ebull;
+        return random ^ (random >> 31);
+    }
+
+    //12 pieces on 64 squares, the side to move, 4 castle rights and 8 en passant files
+    constexpr int NUM_ZOBRIST_RANDOMS = { 781 };
+
+    constexpr BitboardTable<NUM_ZOBRIST_RANDOMS> generateZobristRandoms() {
+        BitboardTable<NUM_ZOBRIST_RANDOMS> table = {};
+        uint64_t state = 353;
+        for (int i = 0; i < NUM_ZOBRIST_RANDOMS; i++) {
+            table.bitboards[i] = nextRandom(&state);
+        }
+        return table;
+    }
+
+    constexpr BitboardTable<NUM_ZOBRIST_RANDOMS> ZOBRIST_RANDOMS = generateZobristRandoms();
+}
\ No newline at end of file
@@ -4,12 +4,24 @@
 
 using namespace std;
 
-int main() {
+int main(int argc, char* argv[]) {
 	Engine engine;
 	string command;
 
-	while (command != "quit") {
-		getline(cin, command);
+	//commands can also be given on the command line, such as "sunstone bench 10", which are run instead of the uci loop
+	if (argc > 1) {
+		for (int i = 1; i < argc; i++) {
+			command.append(i > 1 ? " " : "");
+			command.append(argv[i]);
+		}
+		engine.receiveCommand(command);
+		return 0;
+	}
+
+	//searches run on their own thread, so this thread is always free to read the next command, such as stop
+	//the output is flushed after everything that is sent, so the gui sees the search's output as soon as it is sent
+	cout << unitbuf;
+	while ((command != "quit") && getline(cin, command)) {
 		engine.receiveCommand(command);
 	}
 }
\ No newline at end of file
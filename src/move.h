@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+
+//a move packed into 16 bits: the square it is from, the square it is to and the promotion flags
+typedef uint16_t Move;
+
+//no legal move goes from a square to the same square, so 0 can be used when there isn't a move
+constexpr Move NULL_MOVE = 0;
+
+inline Move encodeMove(unsigned char from, unsigned char to, unsigned char flags) {
+    return from | (to << 6) | (flags << 12);
+}
+
+inline unsigned char getMoveFrom(Move move) {
+    return move & 63;
+}
+
+inline unsigned char getMoveTo(Move move) {
+    return (move >> 6) & 63;
+}
+
+inline unsigned char getMoveFlags(Move move) {
+    return move >> 12;
+}
+
+//no chess position has more than 218 legal moves
+constexpr int MAX_MOVES = 256;
+
+//the score used to order the move is stored next to it, so a move and its score share a cache line
+struct ScoredMove {
+    Move move;
+    int16_t score;
+};
+
+class MoveList {
+private:
+    ScoredMove m_moves[MAX_MOVES];
+    int m_size;
+
+public:
+    MoveList() : m_size(0) {}
+
+    inline void addMove(Move move) {
+        m_moves[m_size].move = move;
+        m_size++;
+    }
+    inline void clear() {
+        m_size = 0;
+    }
+    inline int size() {
+        return m_size;
+    }
+    inline Move getMove(int index) {
+        return m_moves[index].move;
+    }
+    inline int16_t getScore(int index) {
+        return m_moves[index].score;
+    }
+    inline void setScore(int index, int16_t score) {
+        m_moves[index].score = score;
+    }
+    inline ScoredMove* begin() {
+        return m_moves;
+    }
+    inline ScoredMove* end() {
+        return m_moves + m_size;
+    }
+};
\ No newline at end of file
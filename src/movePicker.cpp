@@ -0,0 +1,104 @@
+#include <algorithm>
+
+#include "movePicker.h"
+#include "constants.h"
+
+MovePicker::MovePicker(Board* board, Move hashMove) : m_board(board), m_hashMove(NULL_MOVE), m_stage(MovePickerStage::HashMove), m_moveNum(0) {
+    //the attacks and pins are worked out once here, and shared by the legality check and both generation stages
+    m_board->prepareMoveGeneration();
+    m_board->saveMoveGenerationState(&m_moveGenerationState);
+    //a move from the transposition table could be from a different position with the same key, so make sure it can be played
+    if ((hashMove != NULL_MOVE) && m_board->isMoveLegal(hashMove)) {
+        m_hashMove = hashMove;
+    }
+}
+
+Move MovePicker::getNextMove() {
+    switch (m_stage) {
+    case MovePickerStage::HashMove:
+        m_stage = MovePickerStage::GenerateCaptures;
+        if (m_hashMove != NULL_MOVE) {
+            return m_hashMove;
+        }
+        [[fallthrough]];
+    case MovePickerStage::GenerateCaptures:
+        m_board->restoreMoveGenerationState(&m_moveGenerationState);
+        m_board->getCaptureMoves(&m_moves);
+        scoreMoves();
+        m_moveNum = 0;
+        m_stage = MovePickerStage::Captures;
+        [[fallthrough]];
+    case MovePickerStage::Captures:
+        //captures that look like they lose material aren't held back until after the quiet moves, see movePicker.h
+        while (m_moveNum < m_moves.size()) {
+            Move move = pickBestMove();
+            //the hash move has already been searched
+            if (move != m_hashMove) {
+                return move;
+            }
+        }
+        m_stage = MovePickerStage::GenerateQuiets;
+        [[fallthrough]];
+    case MovePickerStage::GenerateQuiets:
+        m_board->restoreMoveGenerationState(&m_moveGenerationState);
+        m_board->getQuietMoves(&m_moves);
+        scoreMoves();
+        m_moveNum = 0;
+        m_stage = MovePickerStage::Quiets;
+        [[fallthrough]];
+    case MovePickerStage::Quiets:
+        while (m_moveNum < m_moves.size()) {
+            Move move = pickBestMove();
+            if (move != m_hashMove) {
+                return move;
+            }
+        }
+        m_stage = MovePickerStage::Finished;
+        [[fallthrough]];
+    default:
+        return NULL_MOVE;
+    }
+}
+
+void MovePicker::scoreMoves() {
+    for (int i = 0; i < m_moves.size(); i++) {
+        m_moves.setScore(i, getMoveScore(m_board, m_moves.getMove(i)));
+    }
+}
+
+//find the best of the moves that haven't been picked yet and swap it to the front of them
+//a cutoff usually comes within the first few moves, so this is cheaper than sorting the whole list
+Move MovePicker::pickBestMove() {
+    ScoredMove* bestMove = m_moves.begin() + m_moveNum;
+    for (ScoredMove* scoredMove = bestMove + 1; scoredMove < m_moves.end(); scoredMove++) {
+        if (scoredMove->score < bestMove->score) {
+            bestMove = scoredMove;
+        }
+    }
+    std::swap(*bestMove, *(m_moves.begin() + m_moveNum));
+
+    m_moveNum++;
+    return m_moves.getMove(m_moveNum - 1);
+}
+
+int MovePicker::getMoveScore(Board* board, Move move) {
+    unsigned char from = getMoveFrom(move);
+    unsigned char to = getMoveTo(move);
+    unsigned char flags = getMoveFlags(move);
+
+    int moveScore = 16384; //scores less than 16384 mean better move; vice versa
+
+    if (board->getPiece(to) < 12) {
+        //give value to taking a high value piece with a low value piece
+        int captureMaterialDelta = (constants::PIECE_VALUES[board->getPiece(to)] + constants::PIECE_VALUES[board->getPiece(from)]) * (board->getTurn() * -2 + 1);
+        moveScore += captureMaterialDelta;
+
+        bool opponentCanRecapture = (board->getAttackingSquares() >> to) & 1ull;
+        moveScore += ((captureMaterialDelta > 0) && opponentCanRecapture) * 800 - 400;
+    }
+
+    //give value to promotions
+    moveScore += (constants::PIECE_VALUES[flags] - constants::PIECE_VALUES[PieceType::WhitePawn]) * (flags > 0);
+
+    return moveScore;
+}
\ No newline at end of file
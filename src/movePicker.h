@@ -0,0 +1,36 @@
+#pragma once
+
+#include "board.h"
+#include "move.h"
+
+enum MovePickerStage {
+    HashMove = 0, GenerateCaptures, Captures, GenerateQuiets, Quiets, Finished
+};
+
+//hands out the moves of a position one at a time, best first
+//each group of moves is only generated and ordered when it is reached, so when the hash move or a capture causes a
+//beta cutoff, the rest of the moves are never generated
+//every capture is tried before any quiet move, including the ones that look like they lose material. when all of the
+//moves were sorted together those came after the quiet moves, but without an exchange evaluator the guess is often wrong,
+//and trying them first gives a much smaller tree
+class MovePicker {
+private:
+    Board* m_board;
+    Move m_hashMove;
+    //the moves searched before a stage is generated overwrite the board's attacks and pins with those of later positions
+    moveGenerationState m_moveGenerationState;
+    char m_stage;
+    MoveList m_moves;
+    int m_moveNum;
+
+    void scoreMoves();
+    Move pickBestMove();
+public:
+    //this prepares the board for move generation, so inCheck() is up to date afterwards
+    MovePicker(Board* board, Move hashMove);
+    //returns NULL_MOVE once all of the moves have been picked
+    Move getNextMove();
+
+    //lower scores are better moves
+    static int getMoveScore(Board* board, Move move);
+};
\ No newline at end of file
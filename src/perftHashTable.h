@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+struct perftHashEntry {
+    uint64_t key;
+    uint64_t data;
+};
+
+//caches the number of leaf nodes below a position at a given depth, so that transpositions are only counted once
+//it is shared between the perft threads, so like the transposition table each entry stores the key xor'd with its
+//data, and an entry torn by two threads writing at once fails the key check
+class PerftHashTable {
+private:
+    std::vector<perftHashEntry> m_table;
+    uint64_t m_indexMask;
+
+    //the depth is kept in the bottom byte of the data and the count in the rest
+    static constexpr int COUNT_SHIFT = 8;
+
+public:
+    //size in megabytes, rounded down to a power of 2 number of entries
+    PerftHashTable(unsigned long long size) {
+        unsigned long long numEntries = 1;
+        while (numEntries * 2 * sizeof(perftHashEntry) <= size * 1024 * 1024) {
+            numEntries *= 2;
+        }
+        m_table.assign(numEntries, { 0ull, 0ull });
+        m_indexMask = numEntries - 1;
+    }
+
+    inline bool probe(uint64_t key, int depth, unsigned long long* count) {
+        perftHashEntry* entry = &m_table[key & m_indexMask];
+        //only read the data once, so that it can't be changed by another thread after the key has been checked
+        uint64_t data = entry->data;
+        if (((entry->key ^ data) != key) || ((data & 0xff) != static_cast<uint64_t>(depth))) {
+            return false;
+        }
+        *count = data >> COUNT_SHIFT;
+        return true;
+    }
+
+    inline void record(uint64_t key, int depth, unsigned long long count) {
+        perftHashEntry* entry = &m_table[key & m_indexMask];
+        uint64_t data = (count << COUNT_SHIFT) | depth;
+        entry->key = key ^ data;
+        entry->data = data;
+    }
+};
\ No newline at end of file
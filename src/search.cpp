@@ -4,41 +4,114 @@
 #include <iostream>
 
 #include "search.h"
+#include "movePicker.h"
 #include "bitboard.h"
 #include "board.h"
 #include "constants.h"
 
 int Search::evaluate() {
-    uint64_t pieceBitboard = m_board->getPiecesBB(PieceType::Black - m_board->getTurn());
+    int evaluation = evaluateWithoutCastling() + evaluateCastling();
+    return evaluation + (-2 * evaluation * m_board->getTurn());
+}
 
-    int numEnemyPieces = 2;
-    while (pieceBitboard) {
-        popLSB(&pieceBitboard);
-        numEnemyPieces++;
-    }
+//the fewer pieces the opponent has left, the more the end game piece square tables are used
+int Search::getEarlyGameWeight() {
+    return m_board->getNumPieces(!m_board->getTurn()) + 2;
+}
 
-    int earlyGame = numEnemyPieces;
+//everything except the castling score, from white's point of view
+//this only depends on what the zobrist key covers, so it is what the eval cache stores
+int Search::evaluateWithoutCastling() {
+    int earlyGame = getEarlyGameWeight();
     int endGame = 16 - earlyGame;
 
+    int evaluation = m_board->getMaterial();
+    evaluation += (m_board->getEarlyGamePST() * earlyGame + m_board->getEndGamePST() * endGame) / 16;
+
+    int pawnEval;
+    if (!m_pawnHashTable.probe(m_board->getPawnKey(), &pawnEval)) {
+        pawnEval = evaluatePawns();
+        m_pawnHashTable.record(m_board->getPawnKey(), pawnEval);
+    }
+    evaluation += pawnEval;
+
+    return evaluation;
+}
+
+//whether each side has castled isn't part of the zobrist key, so the castling score is never cached, from white's point of view
+int Search::evaluateCastling() {
+    return m_board->getCastleScore() * 2 * (getEarlyGameWeight() - 5);
+}
+
+//look the static evaluation up in the eval cache before calculating it, as the same positions are often reached through different lines
+int Search::getStaticEval() {
+    uint64_t key = m_board->getZobristKey(m_board->getPly());
+    int evaluation;
+    m_numEvalProbes++;
+    if (m_evalHashTable.probe(key, &evaluation)) {
+        m_numEvalHits++;
+    }
+    else {
+        evaluation = evaluateWithoutCastling();
+        m_evalHashTable.record(key, evaluation);
+    }
+    evaluation += evaluateCastling();
+    return evaluation + (-2 * evaluation * m_board->getTurn());
+}
+
+//score passed, isolated and doubled pawns, from white's point of view
+int Search::evaluatePawns() {
+    const uint64_t aFile = 0x0101010101010101ull;
+    const uint64_t pawns[2] = { m_board->getPiecesBB(PieceType::WhitePawn), m_board->getPiecesBB(PieceType::BlackPawn) };
+
     int evaluation = 0;
-    int piecePositionEval = 0;
-
-    for (int typeOfPiece = 2; typeOfPiece < 12; typeOfPiece++) {
-        pieceBitboard = m_board->getPiecesBB(typeOfPiece);
-        while (pieceBitboard) {
-            char square = popLSB(&pieceBitboard);
-            piecePositionEval += constants::PIECE_SQUARE_TABLES_EARLY_GAME[typeOfPiece * 64 + square] * earlyGame;
-            piecePositionEval += constants::PIECE_SQUARE_TABLES_END_GAME[typeOfPiece * 64 + square] * endGame;
-            evaluation += constants::PIECE_VALUES[typeOfPiece];
+    for (int side = 0; side < 2; side++) {
+        int sideEvaluation = 0;
+        uint64_t pawnBitboard = pawns[side];
+        while (pawnBitboard) {
+            char square = popLSB(&pawnBitboard);
+            char file = square % 8;
+            char row = square / 8;
+
+            uint64_t fileMask = aFile << file;
+            uint64_t adjacentFilesMask = ((fileMask << 1) & ~aFile) | ((fileMask >> 1) & ~(aFile << 7));
+
+            //white pawns move towards the top of the board (the lower square numbers) and black pawns towards the bottom
+            uint64_t squaresInFront = side ? ~0ull << (row * 8 + 8) : (1ull << (row * 8)) - 1;
+
+            //a pawn is passed if no enemy pawns can block or take it on its way to promotion
+            if (!(pawns[!side] & (fileMask | adjacentFilesMask) & squaresInFront)) {
+                sideEvaluation += constants::PASSED_PAWN_BONUSES[side ? row : 7 - row];
+            }
+
+            //an isolated pawn has no friendly pawns on the files next to it to defend it
+            if (!(pawns[side] & adjacentFilesMask)) {
+                sideEvaluation -= constants::ISOLATED_PAWN_PENALTY;
+            }
+
+            //a doubled pawn has a friendly pawn in front of it on the same file
+            if (pawns[side] & fileMask & squaresInFront) {
+                sideEvaluation -= constants::DOUBLED_PAWN_PENALTY;
+            }
         }
+        evaluation += side ? -sideEvaluation : sideEvaluation;
     }
-    evaluation += piecePositionEval / 16;
-    evaluation += m_board->getCastleScore() * 2 * (earlyGame - 5);
-    m_numPositions++;
-    return evaluation + (-2 * evaluation * m_board->getTurn());
+
+    return evaluation;
 }
 
-int Search::search(bool* cancelSearch, int depth, int plyFromRoot, int alpha, int beta, char numExtensions) {
+int Search::search(std::atomic<bool>* cancelSearch, int depth, int plyFromRoot, int alpha, int beta, char numExtensions) {
+    long long numPositions = m_numPositions.load(std::memory_order_relaxed);
+    if ((m_hasStopTime || m_nodeLimit) && (numPositions >= m_nextTimeCheck)) {
+        m_nextTimeCheck = numPositions + constants::TIME_CHECK_INTERVAL;
+        //don't check the node limit any less often than it needs to be checked to stop on time
+        if (m_nodeLimit) {
+            m_nextTimeCheck = std::min(m_nextTimeCheck, m_nodeLimit);
+        }
+        if ((m_hasStopTime && (std::chrono::steady_clock::now() >= m_stopTime.load())) || (m_nodeLimit && (numPositions >= m_nodeLimit))) {
+            *cancelSearch = true;
+        }
+    }
     if (*cancelSearch) {
         return 0;
     }
@@ -47,38 +120,26 @@ int Search::search(bool* cancelSearch, int depth, int plyFromRoot, int alpha, in
     }
     
     int TTEval;
-    unsigned char bestMove = 255;
-    if (m_transpositionTable.probeHash(&TTEval, m_board->getZobristKey(m_board->getPly()), depth, alpha, beta, &bestMove)) {
+    Move hashMove = NULL_MOVE;
+    if (m_transpositionTable->probeHash(&TTEval, m_board->getZobristKey(m_board->getPly()), depth, alpha, beta, &hashMove)) {
         return findMateValue(TTEval, plyFromRoot);
     }
 
     char hashType = HashType::Alpha;
+    //keep the previous best move if none of the moves raise alpha
+    Move bestMove = hashMove;
 
-    unsigned char numLegalMoves;
-    unsigned char legalMovesFrom[256];
-    unsigned char legalMovesTo[256];
-    unsigned char legalMovesFlags[256];
-    unsigned int legalMovesOrder[256];
+    MovePicker movePicker(m_board, hashMove);
 
-    m_board->getLegalMoves(&numLegalMoves, legalMovesFrom, legalMovesTo, legalMovesFlags);
+    bool extension = (numExtensions < 12) && m_board->inCheck();
 
     const int mateValue = std::numeric_limits<int>::max() / 2 - plyFromRoot - 1;
 
-    if (numLegalMoves == 0) {
-        if (m_board->inCheck()) {
-            return -mateValue;
-        }
-        return 0;
-    }
-
-    orderMoves(legalMovesFrom, legalMovesTo, legalMovesFlags, legalMovesOrder, numLegalMoves, bestMove);
-
-    bool extension = (numExtensions < 12) && m_board->inCheck();
-
-    for (int moveNum = 0; moveNum < numLegalMoves; moveNum++) {
-        unMakeMoveState prevMoveState;
-        m_board->getUnMakeMoveState(&prevMoveState, legalMovesTo[legalMovesOrder[moveNum]]);
-        m_board->makeMove(legalMovesFrom[legalMovesOrder[moveNum]], legalMovesTo[legalMovesOrder[moveNum]], legalMovesFlags[legalMovesOrder[moveNum]]);
+    int moveNum = 0;
+    Move move;
+    while ((move = movePicker.getNextMove()) != NULL_MOVE) {
+        char takenPiece = m_board->getPiece(getMoveTo(move));
+        m_board->makeMove(move);
         int evaluation;
 
         //detect 50 move rule
@@ -95,11 +156,12 @@ int Search::search(bool* cancelSearch, int depth, int plyFromRoot, int alpha, in
                 evaluation = 0;
             }
             else {
-                bool thisMoveExtension = extension || ((numExtensions < 12) && (m_board->getPiece(legalMovesTo[legalMovesOrder[moveNum]]) == (PieceType::BlackPawn - m_board->getTurn())) && ((legalMovesTo[legalMovesOrder[moveNum]] >= 48) || (legalMovesTo[legalMovesOrder[moveNum]] <= 15)));
+                unsigned char to = getMoveTo(move);
+                bool thisMoveExtension = extension || ((numExtensions < 12) && (m_board->getPiece(to) == (PieceType::BlackPawn - m_board->getTurn())) && ((to >= 48) || (to <= 15)));
 
                 bool needsFullSearch = true;
 
-                if ((moveNum >= 3) && (!thisMoveExtension) && (depth >= 3) && (prevMoveState.takenPieceType == PieceType::All)) {
+                if ((moveNum >= 3) && (!thisMoveExtension) && (depth >= 3) && (takenPiece == PieceType::All)) {
                     evaluation = -search(cancelSearch, depth - 2 + thisMoveExtension, plyFromRoot + 1, -beta, -alpha, numExtensions + thisMoveExtension);
 
                     needsFullSearch = evaluation > alpha;
@@ -111,28 +173,39 @@ int Search::search(bool* cancelSearch, int depth, int plyFromRoot, int alpha, in
             }
         }
 
-        m_board->unMakeMove(legalMovesFrom[legalMovesOrder[moveNum]], legalMovesTo[legalMovesOrder[moveNum]], legalMovesFlags[legalMovesOrder[moveNum]], &prevMoveState);
+        m_board->unMakeMove(move);
         if (*cancelSearch) {
             return 0;
         }
         if (evaluation >= beta) {
-            m_transpositionTable.recordHash(m_board->getZobristKey(m_board->getPly()), depth, findMateDist(beta, plyFromRoot), HashType::Beta, legalMovesOrder[moveNum]);
+            m_transpositionTable->recordHash(m_board->getZobristKey(m_board->getPly()), depth, findMateDist(beta, plyFromRoot), HashType::Beta, move);
             return beta;
         }
         
         if (evaluation > alpha) {
-            bestMove = legalMovesOrder[moveNum];
+            bestMove = move;
             hashType = HashType::Exact;
             alpha = evaluation;
         }
+
+        moveNum++;
+    }
+
+    //checkmate or stalemate
+    if (moveNum == 0) {
+        if (m_board->inCheck()) {
+            return -mateValue;
+        }
+        return 0;
     }
 
-    m_transpositionTable.recordHash(m_board->getZobristKey(m_board->getPly()), depth, findMateDist(alpha, plyFromRoot), hashType, bestMove);
+    m_transpositionTable->recordHash(m_board->getZobristKey(m_board->getPly()), depth, findMateDist(alpha, plyFromRoot), hashType, bestMove);
     return alpha;
 }
 
 int Search::quiescenceSearch(int plyFromRoot, int alpha, int beta) {
-    int evaluation = evaluate();
+    m_numPositions.store(m_numPositions.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    int evaluation = getStaticEval();
 
     if (evaluation >= beta) {
         return beta;
@@ -140,23 +213,16 @@ int Search::quiescenceSearch(int plyFromRoot, int alpha, int beta) {
 
     alpha = max(alpha, evaluation);
 
-    unsigned char numLegalMoves;
-    unsigned char legalMovesFrom[256];
-    unsigned char legalMovesTo[256];
-    unsigned char legalMovesFlags[256];
-    unsigned int legalMovesOrder[256];
-
-    m_board->getCaptureMoves(&numLegalMoves, legalMovesFrom, legalMovesTo, legalMovesFlags);
-
-    orderMoves(legalMovesFrom, legalMovesTo, legalMovesFlags, legalMovesOrder, numLegalMoves, 255);
+    MoveList moves;
+    m_board->prepareMoveGeneration();
+    m_board->getCaptureMoves(&moves);
 
-    for (int moveNum = 0; moveNum < numLegalMoves; moveNum++) {
-        unMakeMoveState prevMoveState;
-        m_board->getUnMakeMoveState(&prevMoveState, legalMovesTo[legalMovesOrder[moveNum]]);
+    orderMoves(&moves, NULL_MOVE);
 
-        m_board->makeMove(legalMovesFrom[legalMovesOrder[moveNum]], legalMovesTo[legalMovesOrder[moveNum]], legalMovesFlags[legalMovesOrder[moveNum]]);
+    for (int moveNum = 0; moveNum < moves.size(); moveNum++) {
+        m_board->makeMove(moves.getMove(moveNum));
         int evaluation = -quiescenceSearch(plyFromRoot + 1, -beta, -alpha);
-        m_board->unMakeMove(legalMovesFrom[legalMovesOrder[moveNum]], legalMovesTo[legalMovesOrder[moveNum]], legalMovesFlags[legalMovesOrder[moveNum]], &prevMoveState);
+        m_board->unMakeMove(moves.getMove(moveNum));
 
         if (evaluation >= beta) {
             return beta;
@@ -167,30 +233,22 @@ int Search::quiescenceSearch(int plyFromRoot, int alpha, int beta) {
     return alpha;
 }
 
-void Search::rootSearch(bool* cancelSearch, unsigned char* from, unsigned char* to, unsigned char* flags, int depth, int* bestMoveNum, int* eval) {
+void Search::rootSearch(std::atomic<bool>* cancelSearch, Move* bestMove, int depth, int* eval) {
     int alpha = -std::numeric_limits<int>::max() / 2;
     int beta = std::numeric_limits<int>::max() / 2;
 
-    unsigned char bestMove = 255;
+    Move hashMove = NULL_MOVE;
     int TTEval;
-    m_transpositionTable.probeHash(&TTEval, m_board->getZobristKey(m_board->getPly()), depth, alpha, beta, &bestMove);
+    m_transpositionTable->probeHash(&TTEval, m_board->getZobristKey(m_board->getPly()), depth, alpha, beta, &hashMove);
     
-    unsigned char numLegalMoves;
-    unsigned char legalMovesFrom[256];
-    unsigned char legalMovesTo[256];
-    unsigned char legalMovesFlags[256];
-    unsigned int legalMovesOrder[256];
+    MoveList moves;
+    m_board->getLegalMoves(&moves);
 
-    m_board->getLegalMoves(&numLegalMoves, legalMovesFrom, legalMovesTo, legalMovesFlags);
+    orderMoves(&moves, hashMove);
 
-    orderMoves(legalMovesFrom, legalMovesTo, legalMovesFlags, legalMovesOrder, numLegalMoves, bestMove);
-    
-    //unsigned char newBestMoveIndex = 255;
-
-    for (int moveNum = 0; moveNum < numLegalMoves; moveNum++) {
-        unMakeMoveState prevMoveState;
-        m_board->getUnMakeMoveState(&prevMoveState, legalMovesTo[legalMovesOrder[moveNum]]);
-        m_board->makeMove(legalMovesFrom[legalMovesOrder[moveNum]], legalMovesTo[legalMovesOrder[moveNum]], legalMovesFlags[legalMovesOrder[moveNum]]);
+    for (int moveNum = 0; moveNum < moves.size(); moveNum++) {
+        Move move = moves.getMove(moveNum);
+        m_board->makeMove(move);
         int evaluation;
 
         //detect 50 move rule
@@ -207,7 +265,8 @@ void Search::rootSearch(bool* cancelSearch, unsigned char* from, unsigned char*
                 evaluation = 0;
             }
             else {
-                bool thisMoveExtension = (m_board->getPiece(legalMovesTo[legalMovesOrder[moveNum]]) == (PieceType::BlackPawn - m_board->getTurn()) && ((legalMovesTo[legalMovesOrder[moveNum]] >= 48) || (legalMovesTo[legalMovesOrder[moveNum]] <= 15)));
+                unsigned char to = getMoveTo(move);
+                bool thisMoveExtension = (m_board->getPiece(to) == (PieceType::BlackPawn - m_board->getTurn()) && ((to >= 48) || (to <= 15)));
 
                 bool needsFullSearch = true;
 
@@ -215,83 +274,59 @@ void Search::rootSearch(bool* cancelSearch, unsigned char* from, unsigned char*
             }
         }
 
-        m_board->unMakeMove(legalMovesFrom[legalMovesOrder[moveNum]], legalMovesTo[legalMovesOrder[moveNum]], legalMovesFlags[legalMovesOrder[moveNum]], &prevMoveState);
+        m_board->unMakeMove(move);
         if (*cancelSearch) {
             if (alpha == -std::numeric_limits<int>::max() / 2) {
                 *eval == TTEval;
             }
             else {
-                m_transpositionTable.recordHash(m_board->getZobristKey(m_board->getPly()), depth - 1, alpha, HashType::Exact, *bestMoveNum);
+                m_transpositionTable->recordHash(m_board->getZobristKey(m_board->getPly()), depth - 1, alpha, HashType::Exact, *bestMove);
                 *eval = alpha;
             }
             return;
         }
         //if the evaluation is a new high, set the hash type in the tt to be exact, as the value calculated will be the exact evaluation
         if (evaluation > alpha) {
-            *from = legalMovesFrom[legalMovesOrder[moveNum]];
-            *to = legalMovesTo[legalMovesOrder[moveNum]];
-            *flags = legalMovesFlags[legalMovesOrder[moveNum]];
-            *bestMoveNum = legalMovesOrder[moveNum];
+            *bestMove = move;
             alpha = evaluation;
         }
     }
 
-    m_transpositionTable.recordHash(m_board->getZobristKey(m_board->getPly()), depth, alpha, HashType::Exact, *bestMoveNum);
+    m_transpositionTable->recordHash(m_board->getZobristKey(m_board->getPly()), depth, alpha, HashType::Exact, *bestMove);
 
     *eval = alpha;
-
-    *cancelSearch = true;
 }
 
-void Search::orderMoves(unsigned char* from, unsigned char* to, unsigned char* flags, unsigned int* moveScores, unsigned char numMoves, unsigned char ttBestMove) {
-    for (unsigned char move = 0; move < numMoves; move++) {
-        //initialise the move score to be a large value so that it remains positive
-        //it must be positive because I am shifting it left and storing the index of the move using the least significant bits
-        moveScores[move] = 16384; //scores less than 16384 mean better move; vice versa
-
-        if (m_board->getPiece(to[move]) < 12) {
-            //give value to taking a high value piece with a low value piece
-            int captureMaterialDelta = (constants::PIECE_VALUES[m_board->getPiece(to[move])] + constants::PIECE_VALUES[m_board->getPiece(from[move])]) * (m_board->getTurn() * -2 + 1);
-            moveScores[move] += captureMaterialDelta;
-
-            bool opponentCanRecapture = (m_board->getAttackingSquares() >> to[move]) & 1ull;
-            moveScores[move] += ((captureMaterialDelta > 0) && opponentCanRecapture) * 800 - 400;
-        }
-
-        //give value to promotions
-        moveScores[move] += (constants::PIECE_VALUES[flags[move]] - constants::PIECE_VALUES[PieceType::WhitePawn]) * (flags[move] > 0);
+void Search::orderMoves(MoveList* moves, Move ttBestMove) {
+    for (int i = 0; i < moves->size(); i++) {
+        Move move = moves->getMove(i);
+        int moveScore = MovePicker::getMoveScore(m_board, move);
 
         //prioritize the best move from the transposition table
-        moveScores[move] *= move != ttBestMove;
+        moveScore *= move != ttBestMove;
 
-        //add the move array index
-        moveScores[move] = (moveScores[move] << 16) | move;
+        moves->setScore(i, moveScore);
     }
 
-    //sort the moves
-    std::sort(moveScores, moveScores + numMoves);
-
-    //shift the bits a further 16 places, left and then 16 places right
-    //this removes the move score from the integer and leaves just the array index of the move
-    for (unsigned char move = 0; move < numMoves; move++) {
-        moveScores[move] = moveScores[move] << 16;
-        moveScores[move] = moveScores[move] >> 16;
+    //insertion sort, as it is stable and fast for the short lists of moves generated in a position
+    for (ScoredMove* i = moves->begin() + 1; i < moves->end(); i++) {
+        ScoredMove scoredMove = *i;
+        ScoredMove* j = i;
+        while ((j > moves->begin()) && ((j - 1)->score > scoredMove.score)) {
+            *j = *(j - 1);
+            j--;
+        }
+        *j = scoredMove;
     }
 }
 
-bool Search::checkForSingleLegalMove(unsigned char* from, unsigned char* to, unsigned char* flags) {
-    unsigned char numLegalMoves;
-    unsigned char legalMovesFrom[256];
-    unsigned char legalMovesTo[256];
-    unsigned char legalMovesFlags[256];
-
-    m_board->getLegalMoves(&numLegalMoves, legalMovesFrom, legalMovesTo, legalMovesFlags);
+bool Search::checkForSingleLegalMove(Move* move) {
+    MoveList moves;
+    m_board->getLegalMoves(&moves);
 
-    *from = legalMovesFrom[0];
-    *to = legalMovesTo[0];
-    *flags = legalMovesFlags[0];
+    *move = moves.getMove(0);
 
-    return numLegalMoves == 1;
+    return moves.size() == 1;
 }
 
 inline int Search::findMateDist(int eval, int plyFromRoot) {
@@ -1,29 +1,78 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+
 #include "board.h"
+#include "evalHashTable.h"
+#include "constants.h"
 
 class Search {
 private:
     Board* m_board;
-    TranspositionTable m_transpositionTable;
-    long long m_numPositions;
+    TranspositionTable* m_transpositionTable;
+    //read by the engine while a helper search is running, for the node count it sends to the gui
+    //only this search's thread changes it, so relaxed loads and stores are enough
+    std::atomic<long long> m_numPositions;
+    //the clock is only read every few hundred nodes, so stopping when the time is up doesn't slow the search down
+    //the stop time can be set by the uci thread while the search is running when a ponder search becomes a timed one, so
+    //searches can't be copied or moved
+    std::atomic<bool> m_hasStopTime;
+    std::atomic<std::chrono::steady_clock::time_point> m_stopTime;
+    long long m_nodeLimit; //0 if there isn't a limit
+    long long m_nextTimeCheck;
+    EvalHashTable m_pawnHashTable;
+    EvalHashTable m_evalHashTable;
+    //how often the static evaluation was found in the eval cache, instead of being calculated
+    long long m_numEvalProbes;
+    long long m_numEvalHits;
 
     //ai
-    int evaluate();
-    int search(bool* cancelSearch, int depth, int plyFromRoot, int alpha, int beta, char numExtensions);
+    int getStaticEval();
+    int getEarlyGameWeight();
+    int evaluateWithoutCastling();
+    int evaluateCastling();
+    int evaluatePawns();
+    int search(std::atomic<bool>* cancelSearch, int depth, int plyFromRoot, int alpha, int beta, char numExtensions);
     int quiescenceSearch(int plyFromRoot, int alpha, int beta);
-    void orderMoves(unsigned char* from, unsigned char* to, unsigned char* flags, unsigned int* moveScores, unsigned char numMoves, unsigned char ttBestMove);
+    void orderMoves(MoveList* moves, Move ttBestMove);
     int findMateDist(int mateValue, int plyFromRoot);
     int findMateValue(int mateDist, int depth);
 public:
-    Search(Board* board) : m_board(board), m_transpositionTable(1024), m_numPositions(0) {}
-    void rootSearch(bool* cancelSearch, unsigned char* from, unsigned char* to, unsigned char* flags, int depth, int* bestMoveNum, int* eval);
-    bool checkForSingleLegalMove(unsigned char* from, unsigned char* to, unsigned char* flags);
+    Search(Board* board, TranspositionTable* transpositionTable) : m_board(board), m_transpositionTable(transpositionTable), m_numPositions(0), m_hasStopTime(false), m_stopTime(), m_nodeLimit(0), m_nextTimeCheck(0),
+        m_pawnHashTable(constants::PAWN_HASH_SIZE), m_evalHashTable(constants::EVAL_HASH_SIZE), m_numEvalProbes(0), m_numEvalHits(0) {}
+    void rootSearch(std::atomic<bool>* cancelSearch, Move* bestMove, int depth, int* eval);
+    //static evaluation of the position from the point of view of the side to move
+    int evaluate();
+    bool checkForSingleLegalMove(Move* move);
 
     inline void resetNodeCount() {
-        m_numPositions = 0;
+        m_numPositions.store(0, std::memory_order_relaxed);
+        m_nextTimeCheck = 0;
+    }
+    //the search cancels itself once the stop time has passed
+    inline void setStopTime(std::chrono::steady_clock::time_point stopTime) {
+        m_stopTime = stopTime;
+        m_hasStopTime = true;
+    }
+    inline void clearStopTime() {
+        m_hasStopTime = false;
+    }
+    //the search cancels itself once it has searched this many nodes, or never if it is 0
+    inline void setNodeLimit(long long nodeLimit) {
+        m_nodeLimit = nodeLimit;
     }
     inline long long getNodeCount() {
-        return m_numPositions;
+        return m_numPositions.load(std::memory_order_relaxed);
+    }
+    inline void resetEvalStats() {
+        m_numEvalProbes = 0;
+        m_numEvalHits = 0;
+    }
+    inline long long getNumEvalProbes() {
+        return m_numEvalProbes;
+    }
+    inline long long getNumEvalHits() {
+        return m_numEvalHits;
     }
 };
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include "timeManager.h"
+#include "constants.h"
+
+using namespace std;
+
+void TimeManager::start(const SearchLimits& limits) {
+	m_startTime = chrono::steady_clock::now();
+	m_searchStartTime = m_startTime;
+	m_bestMove = NULL_MOVE;
+	m_bestMoveStability = 0;
+	m_eval = 0;
+	m_lastDepthEnd = 0;
+	m_lastDepthTime = 0;
+	m_depthBeforeLastTime = 0;
+
+	//a go command without any limits searches for 10 seconds
+	m_useClock = limits.time > 0;
+	m_timed = m_useClock || (limits.moveTime > 0) || !(limits.infinite || (limits.depth > 0) || (limits.nodes > 0));
+	m_optimumTime = 10000;
+	m_hardLimit = 10000;
+	if (limits.moveTime > 0) {
+		m_optimumTime = limits.moveTime;
+		m_hardLimit = limits.moveTime;
+	}
+	else if (m_useClock) {
+		//leave some time for the gui to receive the move, so that the engine doesn't lose on time when the clock is low
+		int available = max(limits.time - constants::MOVE_OVERHEAD, 1);
+		int movesLeft = limits.movesToGo > 0 ? min(limits.movesToGo, constants::DEFAULT_MOVES_LEFT) : constants::DEFAULT_MOVES_LEFT;
+		m_optimumTime = available / movesLeft + limits.increment * 3 / 4;
+		//with one move left before the next time control there is no need to save time for later moves
+		m_hardLimit = min(m_optimumTime * 5, limits.movesToGo == 1 ? available * 4 / 5 : available / 3);
+		m_optimumTime = min(m_optimumTime, m_hardLimit);
+	}
+	m_softLimit = m_optimumTime;
+}
+
+void TimeManager::update(Move bestMove, int eval) {
+	//depths are timed from the start of the search, as the clock is restarted on ponderhit
+	int timeSearched = getTimeSearched();
+	m_depthBeforeLastTime = m_lastDepthTime;
+	m_lastDepthTime = timeSearched - m_lastDepthEnd;
+	m_lastDepthEnd = timeSearched;
+
+	//the first depth has nothing to be compared with
+	if (m_bestMove == NULL_MOVE) {
+		m_bestMove = bestMove;
+		m_eval = eval;
+		return;
+	}
+
+	m_bestMoveStability = bestMove == m_bestMove ? min(m_bestMoveStability + 1, constants::MAX_BEST_MOVE_STABILITY) : 0;
+	//take longer over a position where the score is falling, as the search has found a problem with the best move
+	int scoreDrop = clamp(m_eval - eval, 0, constants::MAX_SCORE_DROP);
+	m_bestMove = bestMove;
+	m_eval = eval;
+
+	if (m_useClock) {
+		long long scale = constants::BEST_MOVE_STABILITY_SCALES[m_bestMoveStability] * (100 + scoreDrop / 2);
+		m_softLimit = static_cast<int>(min<long long>(m_optimumTime * scale / 10000, m_hardLimit));
+	}
+}
+
+bool TimeManager::shouldStartNextDepth() {
+	if (!m_timed) {
+		return true;
+	}
+	int elapsed = getElapsed();
+	if (elapsed >= m_softLimit) {
+		return false;
+	}
+	if (!m_useClock) {
+		return true;
+	}
+
+	//each depth takes a few times longer than the last, so if the next depth isn't going to finish before the hard limit
+	//the time would be better saved for later moves
+	int branchingFactor = 2;
+	if (m_depthBeforeLastTime > 0) {
+		branchingFactor = clamp(m_lastDepthTime / m_depthBeforeLastTime, 2, 4);
+	}
+	return elapsed + m_lastDepthTime * branchingFactor <= m_hardLimit;
+}
+
+int TimeManager::getElapsed() {
+	return static_cast<int>(chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - m_startTime.load()).count());
+}
+
+int TimeManager::getTimeSearched() {
+	return static_cast<int>(chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - m_searchStartTime).count());
+}
\ No newline at end of file
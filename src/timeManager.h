@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>
+#include <atomic>
+
+#include "move.h"
+
+//the limits given by a go command, where 0 means there isn't a limit
+struct SearchLimits {
+	int time; //time left on the clock of the side to move
+	int increment;
+	int movesToGo; //moves until the next time control, or 0 if the time has to last the rest of the game
+	int moveTime; //exact time to search for
+	int depth;
+	long long nodes;
+	bool infinite; //search until told to stop
+	bool ponder; //search the position after the expected reply, until told that it was played or to stop
+};
+
+//decides how long to search for
+//the hard limit is the most time the search is ever allowed, and it stops itself part of the way through a depth when
+//it reaches it. the soft limit is checked after every depth, and is lengthened while the best move keeps changing or
+//the score is falling, and shortened when the same move has been best for a long time
+class TimeManager {
+private:
+	//restarted by the uci thread when a ponder search becomes a timed one
+	std::atomic<std::chrono::steady_clock::time_point> m_startTime;
+	std::chrono::steady_clock::time_point m_searchStartTime; //including any time spent pondering
+	bool m_timed;
+	bool m_useClock;
+	int m_optimumTime; //soft limit before it is scaled by how settled the search is
+	int m_softLimit;
+	int m_hardLimit;
+
+	//what happened in the previous depths
+	Move m_bestMove;
+	int m_bestMoveStability; //number of depths in a row that the best move has stayed the same
+	int m_eval;
+	int m_lastDepthEnd; //milliseconds into the search that the last depth finished, including any time spent pondering
+	int m_lastDepthTime; //milliseconds taken by each of the last two depths
+	int m_depthBeforeLastTime;
+
+public:
+	TimeManager() : m_timed(false), m_useClock(false), m_optimumTime(0), m_softLimit(0), m_hardLimit(0), m_bestMove(NULL_MOVE),
+		m_bestMoveStability(0), m_eval(0), m_lastDepthEnd(0), m_lastDepthTime(0), m_depthBeforeLastTime(0) {}
+
+	void start(const SearchLimits& limits);
+
+	//the expected reply was played, so the clock is started from now
+	inline void ponderhit() {
+		m_startTime = std::chrono::steady_clock::now();
+	}
+
+	//called after every depth that is completed
+	void update(Move bestMove, int eval);
+
+	//whether there is likely to be time for the next depth to finish
+	bool shouldStartNextDepth();
+
+	//milliseconds since the clock started
+	int getElapsed();
+	//milliseconds since the search started, including any time spent pondering
+	int getTimeSearched();
+
+	inline std::chrono::steady_clock::time_point getStopTime() {
+		return m_startTime.load() + std::chrono::milliseconds(m_hardLimit);
+	}
+	//false if the search only stops when it reaches its depth or node limit, or is told to
+	inline bool isTimed() {
+		return m_timed;
+	}
+	//whether the time comes from the clock, rather than being a fixed time for the move
+	inline bool usesClock() {
+		return m_useClock;
+	}
+};
\ No newline at end of file
@@ -1,5 +1,17 @@
 #include <iostream>
 #include <limits>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+#ifdef _WIN32
+#include <malloc.h>
+#endif
 
 #include "constants.h"
 #include "transpositionTable.h"
@@ -7,63 +19,212 @@
 using namespace std;
 
 TranspositionTable::~TranspositionTable() {
-	delete[] m_table;
+	freeTable();
+}
+
+TranspositionTable::TranspositionTable(unsigned long long size) : m_table(nullptr), m_generation(0) {
+	resize(size);
 }
 
-TranspositionTable::TranspositionTable(unsigned long long size) {
-	unsigned long long maxNumEntries = size * 1024 * 1024 / sizeof(ttEntry);
-	m_numEntries = 1;
-	maxNumEntries = maxNumEntries >> 1;
-	m_keySize = 64;
-	while (maxNumEntries) {
-		maxNumEntries = maxNumEntries >> 1;
-		m_numEntries = m_numEntries << 1;
-		m_keySize--; 
+void TranspositionTable::resize(unsigned long long size) {
+	freeTable();
+	m_size = size;
+}
+
+void TranspositionTable::allocate() {
+	if (m_table) {
+		return;
+	}
+
+	//a size the computer doesn't have enough memory for is halved until it fits, instead of the engine giving up
+	unsigned long long requestedSize = m_size;
+	while (true) {
+		unsigned long long maxNumBuckets = m_size * 1024 * 1024 / sizeof(ttBucket);
+		m_numBuckets = 1;
+		maxNumBuckets = maxNumBuckets >> 1;
+		m_keySize = 64;
+		while (maxNumBuckets) {
+			maxNumBuckets = maxNumBuckets >> 1;
+			m_numBuckets = m_numBuckets << 1;
+			m_keySize--;
+		}
+
+		if (allocateTable(m_numBuckets * sizeof(ttBucket))) {
+			break;
+		}
+		if (m_size <= 1) {
+			cout << "info string failed to allocate the transposition table\n" << flush;
+			exit(EXIT_FAILURE);
+		}
+		m_size /= 2;
+	}
+	if (m_size != requestedSize) {
+		cout << "info string failed to allocate " << requestedSize << "MB for the transposition table, using " << m_size << "MB instead\n" << flush;
 	}
-	
-	m_table = new ttEntry[m_numEntries];
+	clear();
+}
 
-	for (unsigned long long i = 0; i < m_numEntries; i++) {
-		m_table[i].depth = 0;
-		m_table[i].bestMoveIndex = 255;
+//returns false if there isn't enough memory
+bool TranspositionTable::allocateTable(unsigned long long size) {
+#if defined(__linux__)
+	//align the table to the huge page size and ask for it to be backed by huge pages, which cuts down on tlb misses
+	constexpr unsigned long long hugePageSize = 2 * 1024 * 1024;
+	size = (size + hugePageSize - 1) / hugePageSize * hugePageSize;
+	m_table = static_cast<ttBucket*>(aligned_alloc(hugePageSize, size));
+	if (m_table) {
+		madvise(m_table, size, MADV_HUGEPAGE);
 	}
+#elif defined(_WIN32)
+	m_table = static_cast<ttBucket*>(_aligned_malloc(size, alignof(ttBucket)));
+#else
+	m_table = static_cast<ttBucket*>(aligned_alloc(alignof(ttBucket), size));
+#endif
+
+	return m_table != nullptr;
+}
+
+void TranspositionTable::freeTable() {
+#ifdef _WIN32
+	_aligned_free(m_table);
+#else
+	free(m_table);
+#endif
+	m_table = nullptr;
 }
 
-void TranspositionTable::recordHash(uint64_t hash, short depth, int eval, char flag, unsigned char bestMoveIndex) {
-	uint64_t index = hash >> m_keySize;
+void TranspositionTable::clear() {
+	//a table that hasn't been allocated yet is cleared when it is
+	if (!m_table) {
+		return;
+	}
+
+	//clearing gigabytes of memory with one thread takes seconds, so split the table between all of the cores
+	unsigned int numThreads = max(thread::hardware_concurrency(), 1u);
+	vector<thread> threads;
+	for (unsigned int i = 0; i < numThreads; i++) {
+		threads.emplace_back(&TranspositionTable::clearBuckets, this, m_numBuckets * i / numThreads, m_numBuckets * (i + 1) / numThreads);
+	}
+	for (thread& clearThread : threads) {
+		clearThread.join();
+	}
+	m_generation = 0;
+}
 
-	uint16_t newKey = hash;
-	m_table[index].key = newKey;
-	m_table[index].depth = depth;
-	m_table[index].bestMoveIndex = bestMoveIndex;
-	m_table[index].flags = flag;
-	m_table[index].eval = eval;
+void TranspositionTable::clearBuckets(unsigned long long start, unsigned long long end) {
+	//an empty entry is 0
+	memset(static_cast<void*>(m_table + start), 0, (end - start) * sizeof(ttBucket));
 }
 
-bool TranspositionTable::probeHash(int* eval, uint64_t hash , short depth, int alpha, int beta, unsigned char* bestMoveIndex) {
-	uint64_t index = hash >> m_keySize;
-	uint64_t keyCheck = hash << 48 >> 48;
-	if (m_table[index].key == keyCheck) {
-		*bestMoveIndex = m_table[index].bestMoveIndex;
-		if (m_table[index].depth >= depth) {
-			if (m_table[index].flags == HashType::Exact) {
-				*eval = m_table[index].eval;
+void TranspositionTable::recordHash(uint64_t hash, short depth, int eval, char flag, Move bestMove) {
+	atomic<uint64_t>* entries = m_table[hash >> m_keySize].entries;
+
+	//use the entry for this position if there is one, otherwise replace the least valuable entry in the bucket
+	atomic<uint64_t>* replacedEntry = &entries[0];
+	int replacedScore = numeric_limits<int>::max();
+	for (int i = 0; i < TT_BUCKET_SIZE; i++) {
+		uint64_t entry = entries[i].load(memory_order_relaxed);
+		if (isEntryFor(entry, hash)) {
+			//don't throw away a much deeper bound on this position that was found during the current search
+			if ((flag != HashType::Exact) && (getGeneration(entry) == m_generation) && (depth + 3 <= getDepth(entry))) {
+				return;
+			}
+			replacedEntry = &entries[i];
+			break;
+		}
+		int score = getReplacementScore(entry);
+		if (score < replacedScore) {
+			replacedEntry = &entries[i];
+			replacedScore = score;
+		}
+	}
+
+	replacedEntry->store(packEntry(hash, eval, depth, flag, bestMove), memory_order_relaxed);
+}
+
+//deep entries are the most expensive to recalculate, but entries from earlier searches are unlikely to be needed again
+int TranspositionTable::getReplacementScore(uint64_t entry) {
+	int age = (NUM_GENERATIONS + m_generation - getGeneration(entry)) % NUM_GENERATIONS;
+	return getDepth(entry) - 8 * age;
+}
+
+bool TranspositionTable::probeHash(int* eval, uint64_t hash, short depth, int alpha, int beta, Move* bestMove) {
+	atomic<uint64_t>* entries = m_table[hash >> m_keySize].entries;
+	for (int i = 0; i < TT_BUCKET_SIZE; i++) {
+		//only read the entry once, so that it can't be changed by another thread after the key has been checked
+		uint64_t entry = entries[i].load(memory_order_relaxed);
+		if (!isEntryFor(entry, hash)) {
+			continue;
+		}
+
+		*bestMove = getBestMove(entry);
+		if (getDepth(entry) >= depth) {
+			int entryEval = getEval(entry);
+			char flags = getFlags(entry);
+			if (flags == HashType::Exact) {
+				*eval = entryEval;
 				return true;
 			}
-			if ((m_table[index].flags == HashType::Alpha) && (m_table[index].eval <= alpha)
-				&& (m_table[index].eval < std::numeric_limits<int>::max() / 2 - constants::MAX_DEPTH - 1)
-				&& (m_table[index].eval > -std::numeric_limits<int>::max() / 2 + constants::MAX_DEPTH + 1)) {
+			if ((flags == HashType::Alpha) && (entryEval <= alpha)
+				&& (entryEval < std::numeric_limits<int>::max() / 2 - constants::MAX_DEPTH - 1)
+				&& (entryEval > -std::numeric_limits<int>::max() / 2 + constants::MAX_DEPTH + 1)) {
 				*eval = alpha;
 				return true;
 			}
-			if ((m_table[index].flags == HashType::Beta) && (m_table[index].eval >= beta)
-				&& (m_table[index].eval < std::numeric_limits<int>::max() / 2 - constants::MAX_DEPTH - 1)
-				&& (m_table[index].eval > -std::numeric_limits<int>::max() / 2 + constants::MAX_DEPTH + 1)) {
+			if ((flags == HashType::Beta) && (entryEval >= beta)
+				&& (entryEval < std::numeric_limits<int>::max() / 2 - constants::MAX_DEPTH - 1)
+				&& (entryEval > -std::numeric_limits<int>::max() / 2 + constants::MAX_DEPTH + 1)) {
 				*eval = beta;
 				return true;
 			}
 		}
+		return false;
 	}
 
 	return false;
+}
+
+uint64_t TranspositionTable::packEntry(uint64_t hash, int eval, short depth, char flags, Move bestMove) {
+	return ((hash & KEY_MASK) << KEY_SHIFT)
+		| (static_cast<uint64_t>(static_cast<uint16_t>(compressEval(eval))) << EVAL_SHIFT)
+		| (static_cast<uint64_t>(bestMove) << BEST_MOVE_SHIFT)
+		| (static_cast<uint64_t>(std::clamp<short>(depth, 0, DEPTH_MASK - 1) + 1) << DEPTH_SHIFT)
+		| (static_cast<uint64_t>(flags) << FLAGS_SHIFT)
+		| (static_cast<uint64_t>(m_generation) << GENERATION_SHIFT);
+}
+
+int TranspositionTable::getHashfull() {
+	//estimate how full the table is from the first thousand entries
+	int numFullEntries = 0;
+	for (int bucket = 0; bucket < 1000 / TT_BUCKET_SIZE; bucket++) {
+		for (int i = 0; i < TT_BUCKET_SIZE; i++) {
+			uint64_t entry = m_table[bucket].entries[i].load(memory_order_relaxed);
+			numFullEntries += (entry != 0) && (getGeneration(entry) == m_generation);
+		}
+	}
+	return numFullEntries * 1000 / (1000 / TT_BUCKET_SIZE * TT_BUCKET_SIZE);
+}
+
+//evaluations are stored in 16 bits, with mate scores moved to the ends of the range so that the distance to mate is kept
+int16_t TranspositionTable::compressEval(int eval) {
+	const int mateValue = std::numeric_limits<int>::max() / 2;
+	const int mateThreshold = numeric_limits<int16_t>::max() - constants::MAX_DEPTH - 1;
+	if (eval >= mateValue - constants::MAX_DEPTH - 1) {
+		return numeric_limits<int16_t>::max() - (mateValue - eval);
+	}
+	if (eval <= -mateValue + constants::MAX_DEPTH + 1) {
+		return -numeric_limits<int16_t>::max() + (mateValue + eval);
+	}
+	return std::clamp(eval, -mateThreshold + 1, mateThreshold - 1);
+}
+
+int TranspositionTable::decompressEval(int16_t eval) {
+	const int mateValue = std::numeric_limits<int>::max() / 2;
+	const int mateThreshold = numeric_limits<int16_t>::max() - constants::MAX_DEPTH - 1;
+	if (eval >= mateThreshold) {
+		return mateValue - (numeric_limits<int16_t>::max() - eval);
+	}
+	if (eval <= -mateThreshold) {
+		return -mateValue + (numeric_limits<int16_t>::max() + eval);
+	}
+	return eval;
 }
\ No newline at end of file
@@ -1,13 +1,20 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 
-struct ttEntry {
-	char flags;
-	uint16_t key;
-	short depth;
-	unsigned char bestMoveIndex;
-	int eval;
+#include "move.h"
+
+//each entry is packed into a single atomic 64 bit word, so two threads writing to the same entry at once can't leave it
+//torn between two positions. relaxed loads and stores are enough, as nothing else is published through the table
+//only the low 19 bits of the key are kept to check the position, as the bits above them have already been used to pick
+//the bucket. a probe of a position that isn't in the table checks 8 entries, so it is mistaken for one of them about
+//once in 65536 probes, the same rate as the single 16 bit checked entry the table used to have
+//the entries are grouped into buckets that fill a cache line, so a probe only ever touches one line of memory
+constexpr int TT_BUCKET_SIZE = 8;
+
+struct alignas(64) ttBucket {
+	std::atomic<uint64_t> entries[TT_BUCKET_SIZE];
 };
 
 enum HashType {
@@ -16,16 +23,81 @@ enum HashType {
 
 class TranspositionTable {
 private:
-	ttEntry* m_table;
-	unsigned long long m_numEntries;
+	ttBucket* m_table;
+	unsigned long long m_size; //megabytes to allocate the next time the table is needed
+	unsigned long long m_numBuckets;
 	char m_keySize;
+	//increased at the start of every search, so entries left over from earlier moves of the game can be replaced first
+	unsigned char m_generation;
+
+	//layout of an entry
+	static constexpr int KEY_SHIFT = 0;
+	static constexpr uint64_t KEY_MASK = (1ull << 19) - 1;
+	static constexpr int EVAL_SHIFT = 19;
+	static constexpr int BEST_MOVE_SHIFT = 35;
+	static constexpr int DEPTH_SHIFT = 51;
+	static constexpr uint64_t DEPTH_MASK = 0x7f;
+	static constexpr int FLAGS_SHIFT = 58;
+	static constexpr int GENERATION_SHIFT = 60;
+	static constexpr int NUM_GENERATIONS = 16;
+
+	bool allocateTable(unsigned long long size);
+	void freeTable();
+	void clearBuckets(unsigned long long start, unsigned long long end);
+
+	uint64_t packEntry(uint64_t hash, int eval, short depth, char flags, Move bestMove);
+	int getReplacementScore(uint64_t entry);
+	static int16_t compressEval(int eval);
+	static int decompressEval(int16_t eval);
+
+	//the depth is stored one higher than it is, so that an empty entry of 0 never matches a position
+	inline static bool isEntryFor(uint64_t entry, uint64_t hash) {
+		return (((entry >> KEY_SHIFT) & KEY_MASK) == (hash & KEY_MASK)) && ((entry >> DEPTH_SHIFT) & DEPTH_MASK);
+	}
+	inline static int getEval(uint64_t entry) {
+		return decompressEval(static_cast<int16_t>(entry >> EVAL_SHIFT));
+	}
+	inline static Move getBestMove(uint64_t entry) {
+		return static_cast<Move>(entry >> BEST_MOVE_SHIFT);
+	}
+	inline static short getDepth(uint64_t entry) {
+		return ((entry >> DEPTH_SHIFT) & DEPTH_MASK) - 1;
+	}
+	inline static char getFlags(uint64_t entry) {
+		return (entry >> FLAGS_SHIFT) & 3;
+	}
+	inline static unsigned char getGeneration(uint64_t entry) {
+		return entry >> GENERATION_SHIFT;
+	}
 
 public:
 	TranspositionTable(unsigned long long size);
 
 	~TranspositionTable();
-	
-	void recordHash(uint64_t hash, short depth, int value, char flag, unsigned char bestMoveIndex);
 
-	bool probeHash(int* value, uint64_t hash, short depth, int alpha, int beta, unsigned char* bestMove);
+	//size in megabytes
+	//the memory isn't allocated until allocate() is called, so that setting the size is instant and starting the engine
+	//doesn't have to wait for the default sized table to be allocated and cleared
+	void resize(unsigned long long size);
+
+	inline unsigned long long getSize() {
+		return m_size;
+	}
+
+	//allocates and clears the table if it hasn't been since it was last resized, must be called before it is used
+	void allocate();
+
+	void clear();
+
+	inline void newSearch() {
+		m_generation = (m_generation + 1) % NUM_GENERATIONS;
+	}
+
+	//permille of the table filled by the current search
+	int getHashfull();
+
+	void recordHash(uint64_t hash, short depth, int value, char flag, Move bestMove);
+
+	//the best move is returned whenever the position is found, even if its score can't be used
+	bool probeHash(int* value, uint64_t hash, short depth, int alpha, int beta, Move* bestMove);
 };
\ No newline at end of file
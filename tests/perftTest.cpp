@@ -0,0 +1,48 @@
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "board.h"
+
+using namespace std;
+
+//counts the positions at a depth from a fen and checks the count against the known value, so that changes to move
+//generation or to making and unmaking moves can be checked, and their speed measured with the nodes per second
+//usage: sunstone_perft_test <depth> <expected positions> <fen>
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        cout << "usage: sunstone_perft_test <depth> <expected positions> <fen>\n";
+        return 1;
+    }
+    int depth = stoi(argv[1]);
+    unsigned long long expectedPositions = stoull(argv[2]);
+    string fen = argv[3];
+    for (int i = 4; i < argc; i++) {
+        fen += " " + string(argv[i]);
+    }
+
+    //boards are too big to be put on the stack
+    auto board = make_unique<Board>();
+    board->loadFromFen(fen);
+    uint64_t zobristKey = board->getZobristKey(board->getPly());
+
+    auto startTime = chrono::high_resolution_clock::now();
+    unsigned long long positions = board->perft(depth);
+    double seconds = chrono::duration<double>(chrono::high_resolution_clock::now() - startTime).count();
+
+    cout << fen << "\n";
+    cout << "depth " << depth << ": " << positions << " positions, expected " << expectedPositions << "\n";
+    cout << seconds * 1000.0 << "ms, " << positions / seconds / 1000000.0 << " million positions per second\n";
+
+    if (positions != expectedPositions) {
+        cout << "FAILED: wrong number of positions\n";
+        return 1;
+    }
+    //every move that was made should have been unmade
+    if (board->getZobristKey(board->getPly()) != zobristKey) {
+        cout << "FAILED: the board wasn't restored after the moves were unmade\n";
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
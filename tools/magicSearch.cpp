@@ -0,0 +1,142 @@
+#include <iostream>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+
+#include "attackTables.h"
+#include "bitboard.h"
+#include "constants.h"
+
+using namespace std;
+
+//searches for magic numbers that make the sliding piece tables smaller than the ones in constants.h
+//each square's section of the table is as big as the largest key its magic gives, so a magic is better if it gives a
+//larger shift or a smaller largest key, and different arrangements of blockers are allowed to share a key if they give
+//the same moves
+
+struct magicSearchJob {
+    char square;
+    bool bishop;
+    vector<uint64_t> blockerBitboards;
+    vector<uint64_t> moves;
+    //the best magic found so far, starting with the one in constants.h
+    uint64_t magic;
+    int shift;
+    uint64_t tableSize;
+};
+
+//returns the number of entries the square's section of the table needs with this magic and shift, or 0 if two
+//arrangements of blockers with different moves get the same key
+//the entries of the table are only counted as used if their stamp matches, so it doesn't need clearing every time
+uint64_t getTableSize(const magicSearchJob& job, uint64_t magic, int shift, vector<uint64_t>* table, vector<unsigned int>* stamps, unsigned int stamp) {
+    uint64_t maxKey = 0ull;
+    for (size_t i = 0; i < job.blockerBitboards.size(); i++) {
+        uint64_t key = (job.blockerBitboards[i] * magic) >> shift;
+        if ((*stamps)[key] != stamp) {
+            (*stamps)[key] = stamp;
+            (*table)[key] = job.moves[i];
+        }
+        else if ((*table)[key] != job.moves[i]) {
+            return 0ull;
+        }
+        maxKey = max(maxKey, key);
+    }
+    return maxKey + 1;
+}
+
+void searchForMagics(vector<magicSearchJob>* jobs, atomic<int>* nextJob, long long attempts) {
+    int jobNum;
+    while ((jobNum = nextJob->fetch_add(1)) < static_cast<int>(jobs->size())) {
+        magicSearchJob* job = &(*jobs)[jobNum];
+        //each square has its own seed, so the results don't depend on how many threads there are
+        mt19937_64 random(353 + jobNum);
+        vector<uint64_t> table(1ull << (64 - job->shift));
+        vector<unsigned int> stamps(table.size(), 0);
+        unsigned int stamp = 0;
+        uint64_t mask = job->blockerBitboards.back();
+
+        for (long long attempt = 0; attempt < attempts; attempt++) {
+            //magics with few bits set work best
+            uint64_t magic = random() & random() & random();
+            //the top bits of the product become the key, so they need to be well mixed for the magic to stand a chance
+            if (popcount((mask * magic) & 0xff00000000000000ull) < 6) {
+                continue;
+            }
+
+            //try to halve the size of the section first, and otherwise just to make the largest key smaller
+            for (int shift = job->shift + 1; shift >= job->shift; shift--) {
+                uint64_t tableSize = getTableSize(*job, magic, shift, &table, &stamps, ++stamp);
+                if (tableSize && (tableSize < job->tableSize)) {
+                    job->magic = magic;
+                    job->shift = shift;
+                    job->tableSize = tableSize;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void printConstants(const vector<magicSearchJob>& jobs, bool bishop) {
+    string name = bishop ? "BISHOP" : "ROOK";
+    string magics = "    constexpr uint64_t " + name + "_MAGICS[64] = { ";
+    string shifts = "    constexpr int " + name + "_SHIFTS[64] = { ";
+    for (int square = 0; square < 64; square++) {
+        const magicSearchJob& job = jobs[bishop * 64 + square];
+        magics += to_string(job.magic) + "u" + (square < 63 ? ", " : " };");
+        shifts += to_string(job.shift) + (square < 63 ? ", " : " };");
+    }
+    cout << magics << "\n" << shifts << "\n";
+}
+
+uint64_t getTableBytes(const vector<magicSearchJob>& jobs) {
+    uint64_t tableSize = 0ull;
+    for (const magicSearchJob& job : jobs) {
+        tableSize += job.tableSize;
+    }
+    return tableSize * sizeof(uint64_t);
+}
+
+//usage: sunstone_magics [attempts per square] [threads]
+int main(int argc, char* argv[]) {
+    long long attempts = argc > 1 ? stoll(argv[1]) : 1000000;
+    unsigned int numThreads = argc > 2 ? stoi(argv[2]) : max(thread::hardware_concurrency(), 1u);
+
+    //start from the magics that are already in use, so that a square only changes if a better magic is found
+    vector<magicSearchJob> jobs(128);
+    for (int i = 0; i < 128; i++) {
+        magicSearchJob* job = &jobs[i];
+        job->square = i % 64;
+        job->bishop = i >= 64;
+        AttackTables::getBlockerBitboards(AttackTables::getBlockerMask(job->square, job->bishop), &job->blockerBitboards);
+        for (uint64_t blockerBitboard : job->blockerBitboards) {
+            job->moves.push_back(AttackTables::calculateSlidingMoves(job->square, blockerBitboard, job->bishop));
+        }
+        job->magic = job->bishop ? constants::BISHOP_MAGICS[job->square] : constants::ROOK_MAGICS[job->square];
+        job->shift = job->bishop ? constants::BISHOP_SHIFTS[job->square] : constants::ROOK_SHIFTS[job->square];
+        vector<uint64_t> table(1ull << (64 - job->shift));
+        vector<unsigned int> stamps(table.size(), 0);
+        job->tableSize = getTableSize(*job, job->magic, job->shift, &table, &stamps, 1);
+    }
+    uint64_t startTableBytes = getTableBytes(jobs);
+
+    cerr << "searching " << attempts << " magics per square with " << numThreads << " threads\n";
+    atomic<int> nextJob(0);
+    vector<thread> threads;
+    for (unsigned int i = 0; i < numThreads; i++) {
+        threads.emplace_back(searchForMagics, &jobs, &nextJob, attempts);
+    }
+    for (thread& searchThread : threads) {
+        searchThread.join();
+    }
+
+    //the constants go to stdout so they can be pasted straight into constants.h
+    printConstants(jobs, false);
+    printConstants(jobs, true);
+    cerr << "sliding piece tables " << startTableBytes << " bytes (" << startTableBytes / 1024 << "KB) before, "
+        << getTableBytes(jobs) << " bytes (" << getTableBytes(jobs) / 1024 << "KB) after\n";
+}
\ No newline at end of file